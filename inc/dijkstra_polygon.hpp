@@ -1,6 +1,9 @@
 #ifndef __DIJKSTRA_POLYGON_HPP__
 #define __DIJKSTRA_POLYGON_HPP__
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace bfreeman {
@@ -8,21 +11,66 @@ namespace bfreeman {
 const size_t START_IDX = 0;
 const size_t END_IDX = 1;
 
-struct Point {
-    double x;
-    double y;
+/*
+ * How the geometry computes with coordinates of type T: Wide holds
+ * the cross products of orientation tests, Distance the lengths of
+ * chords and paths, and exact says whether orientation tests are
+ * exact or allow the ORIENTATION_EPSILON tolerance.
+ *
+ * The geometry and the free functions below are instantiated for
+ * double, float (half the memory per point, tested in double) and
+ * int32_t grid coordinates (such as millimetres), whose orientation
+ * tests are exact in 64-bit integers as long as every coordinate is
+ * within +-2^30. Lengths are always computed in double.
+ */
+template<typename T>
+struct ScalarTraits;
+
+template<>
+struct ScalarTraits<double> {
+    using Wide = double;
+    using Distance = double;
+    static const bool exact = false;
+};
+
+template<>
+struct ScalarTraits<float> {
+    using Wide = double;
+    using Distance = float;
+    static const bool exact = false;
 };
 
-struct DijkstraData {
-    std::vector<Point> path;
-    double distance;
+template<>
+struct ScalarTraits<int32_t> {
+    using Wide = int64_t;
+    using Distance = double;
+    static const bool exact = true;
 };
 
-struct Segment {
-    Point p1;
-    Point p2;
+template<typename T>
+struct BasicPoint {
+    T x;
+    T y;
 };
 
+using Point = BasicPoint<double>;
+
+template<typename T>
+struct BasicDijkstraData {
+    std::vector<BasicPoint<T>> path;
+    typename ScalarTraits<T>::Distance distance;
+};
+
+using DijkstraData = BasicDijkstraData<double>;
+
+template<typename T>
+struct BasicSegment {
+    BasicPoint<T> p1;
+    BasicPoint<T> p2;
+};
+
+using Segment = BasicSegment<double>;
+
 /*
  * Represents a vertex of the polygon if interior is false
  * or the start/end point if interior is true.
@@ -38,22 +86,31 @@ struct IndexPair {
     IndexPair(size_t i, size_t j, bool interior) : i(i), j(j), interior(interior) {}
 };
 
-struct Edge {
+template<typename T>
+struct BasicEdge {
     IndexPair idxp;
-    double distance;
+    typename ScalarTraits<T>::Distance distance;
 };
 
+using Edge = BasicEdge<double>;
+
 /*
  * Generates the adjacency list of the graph representing
  * the polygon and holes. The nodes of the graph are the
  * vertices of the polygon and holes, the start point, and
  * the end point. The edges are segments between nodes that
  * are completely inside the polygon (and not in any holes).
+ *
+ * The rows of the vertices are independent of each other and
+ * are built across threads worker threads (one per hardware
+ * thread if threads is 0); the result does not depend on threads.
  */
-std::vector<std::vector<Edge>> generate_adjacency_list(
-        const std::vector<std::vector<Point>>& polygon,
-        const Point& start,
-        const Point& end
+template<typename T>
+std::vector<std::vector<BasicEdge<T>>> generate_adjacency_list(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const BasicPoint<T>& start,
+        const BasicPoint<T>& end,
+        const size_t threads = 1
 );
 
 /*
@@ -67,6 +124,9 @@ std::vector<std::vector<Edge>> generate_adjacency_list(
  * of the boundary or holes, all holes are completely within the
  * boundary, and no holes overlap)
  *
+ * Rebuilds the whole graph on every call; use a PolygonIndex
+ * (polygon_index.hpp) to run many queries against one polygon.
+ *
  * @param polygon a represented by (x, y) coordinates.
  *        The first std::vector defines the boundary.
  *        Subsequent std::vectors define holes.
@@ -85,6 +145,46 @@ DijkstraData dijkstra_path(
         const Point& end
 );
 
+/*
+ * Same as above for a polygon of any coordinate type in
+ * ScalarTraits, searching the adjacency list of
+ * generate_adjacency_list directly (so the double version
+ * gives the same paths as above, without a PolygonIndex)
+ */
+template<typename T>
+BasicDijkstraData<T> dijkstra_path(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const BasicPoint<T>& start,
+        const BasicPoint<T>& end
+);
+
+struct QueryStats;
+
+/*
+ * Same as above, also adding the work done to stats
+ * (see query_stats.hpp)
+ */
+DijkstraData dijkstra_path(
+        const std::vector<std::vector<Point>>& polygon,
+        const Point& start,
+        const Point& end,
+        QueryStats& stats
+);
+
+/*
+ * Runs dijkstra_path for every (start, end) pair in queries.
+ * The chords between the polygon vertices are built once and
+ * shared by all queries, which are spread over a pool of worker
+ * threads (one per hardware thread if threads is 0).
+ *
+ * @return one DijkstraData per query, in the order of queries
+ */
+std::vector<DijkstraData> dijkstra_paths(
+        const std::vector<std::vector<Point>>& polygon,
+        const std::vector<std::pair<Point, Point>>& queries,
+        const size_t threads = 0
+);
+
 } // namespace bfreeman
 
 #endif // #ifndef __DIJKSTRA_POLYGON_HPP__
\ No newline at end of file
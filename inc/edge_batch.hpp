@@ -0,0 +1,68 @@
+#ifndef __EDGE_BATCH_HPP__
+#define __EDGE_BATCH_HPP__
+
+#include <vector>
+#include "dijkstra_polygon.hpp"
+
+namespace bfreeman {
+
+enum SimdLevel {
+    SCALAR = 0,  // one edge at a time through check_intersect
+    SSE2 = 1,    // two edges per instruction, four per step
+    AVX2 = 2     // four edges per instruction, eight per step
+};
+
+/*
+ * @return the widest SimdLevel the running processor supports
+ */
+SimdLevel simd_level();
+
+/*
+ * A list of edges with their endpoints split into one array
+ * per coordinate, so a chord can be tested against several
+ * consecutive edges at once with SIMD instructions.
+ *
+ * The vector kernels evaluate exactly the same expressions as
+ * check_intersect (including its ORIENTATION_EPSILON tolerances), so
+ * every SimdLevel gives the same answers.
+ */
+class EdgeBatch {
+public:
+    EdgeBatch() = default;
+
+    /*
+     * Copies the boundary and hole edges of polygon,
+     * ring by ring, in winding order
+     */
+    explicit EdgeBatch(const std::vector<std::vector<Point>>& polygon);
+
+    void push_back(const Segment& edge);
+
+    size_t size() const;
+
+    /*
+     * @return true if segment intersects (as in check_intersect)
+     *         any edge in [first, last), false otherwise
+     */
+    bool intersects(const Segment& segment, const size_t first, const size_t last) const;
+
+    /*
+     * Same as above, using at most the given SimdLevel
+     */
+    bool intersects(const Segment& segment, const size_t first, const size_t last, const SimdLevel level) const;
+
+    /*
+     * @return true if segment intersects any of the edges
+     */
+    bool intersects(const Segment& segment) const;
+
+private:
+    std::vector<double> x1;
+    std::vector<double> y1;
+    std::vector<double> x2;
+    std::vector<double> y2;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __EDGE_BATCH_HPP__
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef __EDGE_BATCH_X86_HPP__
+#define __EDGE_BATCH_X86_HPP__
+
+#include "dijkstra_polygon.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EDGE_BATCH_X86
+#endif
+
+namespace bfreeman {
+
+#ifdef EDGE_BATCH_X86
+
+/*
+ * The SIMD kernels behind EdgeBatch::intersects, each compiled for
+ * its own instruction set; only call them when simd_level allows.
+ *
+ * @return true if segment intersects (as in check_intersect) any of
+ *         the count edges (x1[k], y1[k]) -> (x2[k], y2[k])
+ */
+bool intersects_sse2(
+        const Segment& segment,
+        const double* x1, const double* y1,
+        const double* x2, const double* y2,
+        const size_t count);
+
+bool intersects_avx2(
+        const Segment& segment,
+        const double* x1, const double* y1,
+        const double* x2, const double* y2,
+        const size_t count);
+
+#endif // #ifdef EDGE_BATCH_X86
+
+} // namespace bfreeman
+
+#endif // #ifndef __EDGE_BATCH_X86_HPP__
\ No newline at end of file
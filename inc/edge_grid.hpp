@@ -0,0 +1,64 @@
+#ifndef __EDGE_GRID_HPP__
+#define __EDGE_GRID_HPP__
+
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_batch.hpp"
+
+namespace bfreeman {
+
+/*
+ * A uniform grid over the bounding box of a polygon where each
+ * cell lists the boundary and hole edges passing through it.
+ * A chord then only needs to be tested against the edges in
+ * the cells it crosses instead of against every edge.
+ *
+ * Cells are gathered with a margin wide enough to cover the
+ * tolerance of check_intersect near the segment, so every edge
+ * touching the segment, or within that tolerance of it, is
+ * found. Testing every edge can also report a long edge that
+ * is nearly parallel to the segment but far from it, as the
+ * tolerance of orientation grows with the length of the edge;
+ * the grid never tests such an edge and does not report it.
+ * The cells are visited in the same order whichever end the
+ * segment starts from.
+ *
+ * Each cell keeps its own copy of its edges in an EdgeBatch, so
+ * the edges of a cell are tested several at a time.
+ */
+class EdgeGrid {
+public:
+    explicit EdgeGrid(const std::vector<std::vector<Point>>& polygon);
+
+    /*
+     * @return true if segment intersects (as in check_intersect)
+     *         any edge of the polygon, false otherwise
+     */
+    bool intersects(const Segment& segment) const;
+
+private:
+    /*
+     * Calls visit(cell) for every cell that may hold a point
+     * within margin of segment. Stops early and returns true
+     * as soon as visit returns true.
+     */
+    template<typename Visit>
+    bool visit_cells(const Segment& segment, const double margin, Visit visit) const;
+
+    std::vector<Segment> edges;
+    EdgeBatch edge_batch;
+    double min_edge_length;
+
+    Point origin;
+    double cell_size;
+    size_t columns;
+    size_t rows;
+
+    // the edges of cell c are cell_edges[cell_offsets[c]]...[cell_offsets[c + 1] - 1]
+    std::vector<size_t> cell_offsets;
+    EdgeBatch cell_edges;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __EDGE_GRID_HPP__
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef __INDEX_FILE_HPP__
+#define __INDEX_FILE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bfreeman {
+
+enum IndexFileStatus {
+    INDEX_FILE_OK = 0,
+    INDEX_FILE_IO_ERROR = 1,       // the file could not be opened, written or mapped
+    INDEX_FILE_NOT_AN_INDEX = 2,   // wrong magic number, or written on a machine of the other byte order
+    INDEX_FILE_BAD_VERSION = 3,    // written in another version of the format
+    INDEX_FILE_TRUNCATED = 4,      // shorter than its header says it is
+    INDEX_FILE_BAD_CHECKSUM = 5    // the contents do not add up to the checksum in the header
+};
+
+// bumped whenever the layout below changes; files of other versions are rejected
+const uint32_t INDEX_FILE_VERSION = 1;
+
+const char INDEX_FILE_MAGIC[8] = {'D', 'P', 'I', 'N', 'D', 'E', 'X', '\0'};
+
+// reads back as another value on a machine of the other byte order
+const uint32_t INDEX_FILE_BYTE_ORDER = 0x01020304;
+
+enum IndexFileFlag {
+    INDEX_FILE_REDUCED = 1,    // built with IndexOptions::reduced
+    INDEX_FILE_EDGE_GRID = 2,  // built with IndexOptions::edge_grid
+    INDEX_FILE_ALL_PAIRS = 4   // holds an all-pairs table
+};
+
+/*
+ * The start of a PolygonIndex file (see PolygonIndex::save).
+ * The sections listed in IndexFileLayout follow it, each as a
+ * raw array in the byte order of the machine that wrote it and
+ * starting at a multiple of 8 bytes, so a mapped file can be
+ * read in place. The checksum covers everything after the
+ * header.
+ */
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint64_t flags;
+    uint64_t ring_count;
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    uint64_t file_size;
+    uint64_t checksum;
+};
+
+/*
+ * Where each section of an index file starts, in bytes from the
+ * start of the file
+ */
+struct IndexFileLayout {
+    size_t ring_sizes;       // uint64_t per ring: the vertex count of the boundary, then of each hole
+    size_t vertices;         // Point per vertex, ring by ring
+    size_t reflex;           // uint8_t per vertex, 0 for vertices left out of a reduced graph
+    size_t offsets;          // uint64_t per node and one more: CompactGraph::offsets
+    size_t targets;          // uint32_t per edge: CompactGraph::targets
+    size_t weights;          // double per edge: CompactGraph::weights
+    size_t table_distances;  // double per pair of vertices, if INDEX_FILE_ALL_PAIRS
+    size_t table_next;       // uint32_t per pair of vertices, if INDEX_FILE_ALL_PAIRS
+    size_t file_size;
+};
+
+IndexFileLayout index_file_layout(const IndexFileHeader& header);
+
+/*
+ * Adds size bytes at data, followed by zeros up to a multiple of
+ * 8 bytes, to the running checksum hash (start from 0). Hashing
+ * consecutive sections in turn gives the same result as hashing
+ * them in one call, as they are padded the same way in the file.
+ */
+uint64_t index_file_checksum(uint64_t hash, const void* data, const size_t size);
+
+/*
+ * A whole file mapped read-only into memory, unmapped again
+ * when the MappedFile is destroyed
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*
+     * @return false if the file could not be opened or mapped
+     */
+    bool is_open() const;
+
+    const uint8_t* data() const;
+
+    size_t size() const;
+
+private:
+    void* memory;
+    size_t length;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __INDEX_FILE_HPP__
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef __INDEXED_HEAP_HPP__
+#define __INDEXED_HEAP_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bfreeman {
+
+/*
+ * A d-ary min-heap of node indices keyed by path distance that
+ * remembers where each node sits, so a shorter path found to a
+ * queued node lowers its key in place instead of queueing the
+ * node again. Nodes with equal keys pop in node order, which
+ * keeps ties resolving to the lowest indices.
+ *
+ * Each node is queued, settled (popped), or neither. These
+ * states are stamped with the epoch of the current search, so
+ * reset starts a new search without clearing any array.
+ */
+class IndexedHeap {
+public:
+    IndexedHeap() = default;
+
+    /*
+     * Empties the heap and marks every node in [0, node_count)
+     * as neither queued nor settled. Allocates only when
+     * node_count is larger than in any earlier search.
+     */
+    void reset(const size_t node_count);
+
+    bool empty() const;
+
+    /*
+     * Queues idx with key, or lowers its key to key if it is
+     * already queued (key must then be at most its current key).
+     * Settled nodes are left alone.
+     */
+    void push_or_decrease(const uint32_t idx, const double key);
+
+    /*
+     * Removes the node with the smallest key and settles it
+     *
+     * @return the removed node
+     */
+    uint32_t pop();
+
+    /*
+     * @return the smallest key queued (the heap must not be empty)
+     */
+    double top_key() const;
+
+    bool is_settled(const uint32_t idx) const;
+
+private:
+    // children of slot s are slots ARITY * s + 1 ... ARITY * s + ARITY
+    static const size_t ARITY = 4;
+
+    struct Entry {
+        double key;
+        uint32_t idx;
+    };
+
+    static bool precedes(const Entry& e1, const Entry& e2);
+
+    void sift_up(size_t slot, const Entry entry);
+    void sift_down(size_t slot, const Entry entry);
+
+    std::vector<Entry> heap;
+
+    // where node idx is in heap, or SETTLED, if stamp[idx] is the current epoch
+    std::vector<uint32_t> slots;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __INDEXED_HEAP_HPP__
\ No newline at end of file
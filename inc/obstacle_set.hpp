@@ -0,0 +1,54 @@
+#ifndef __OBSTACLE_SET_HPP__
+#define __OBSTACLE_SET_HPP__
+
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_batch.hpp"
+
+namespace bfreeman {
+
+/*
+ * Temporary obstacles for queries (see QueryOptions::obstacles):
+ * simple polygons, wound counterclockwise, that paths may not
+ * cross or run through but that are not part of any index. Each
+ * obstacle keeps its bounding box so a segment nowhere near it
+ * costs four comparisons. Built once, an ObstacleSet can be
+ * shared by any number of concurrent queries.
+ */
+class ObstacleSet {
+public:
+    ObstacleSet() = default;
+
+    explicit ObstacleSet(const std::vector<std::vector<Point>>& obstacles);
+
+    /*
+     * @return true if segment crosses or touches the edge of an
+     *         obstacle (as in check_intersect) or runs through
+     *         one, false otherwise
+     */
+    bool blocks(const Segment& segment) const;
+
+    /*
+     * @return true if point is strictly inside an obstacle
+     */
+    bool contains(const Point& point) const;
+
+    bool empty() const;
+
+    const std::vector<std::vector<Point>>& get_obstacles() const;
+
+private:
+    std::vector<std::vector<Point>> obstacles;
+
+    // the edges of obstacle i are edges[edge_offsets[i]] to edges[edge_offsets[i + 1] - 1]
+    EdgeBatch edges;
+    std::vector<size_t> edge_offsets;
+
+    // the bounding box of each obstacle
+    std::vector<Point> box_min;
+    std::vector<Point> box_max;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __OBSTACLE_SET_HPP__
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__
+
+#include <cstddef>
+#include <functional>
+
+namespace bfreeman {
+
+// adjacency list rows claimed at once by a worker building a graph
+const size_t ROW_CHUNK = 8;
+
+/*
+ * @return threads, or the number of hardware threads if threads is 0
+ */
+size_t worker_count(const size_t threads);
+
+/*
+ * Calls body(idx) for every idx in [0, count) across a pool of
+ * worker_count(threads) threads. Workers claim indices in chunks
+ * of chunk consecutive indices until none are left, so uneven
+ * per-index costs still balance. Returns once every call is done.
+ */
+void parallel_for(
+        const size_t count,
+        const size_t threads,
+        const size_t chunk,
+        const std::function<void(size_t)>& body
+);
+
+/*
+ * Same as above, calling body(worker, idx) where worker, in
+ * [0, worker_count(threads)), tells apart the threads making
+ * the calls, so each can keep state of its own
+ */
+void parallel_for(
+        const size_t count,
+        const size_t threads,
+        const size_t chunk,
+        const std::function<void(size_t, size_t)>& body
+);
+
+} // namespace bfreeman
+
+#endif // #ifndef __PARALLEL_HPP__
\ No newline at end of file
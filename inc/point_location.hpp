@@ -0,0 +1,114 @@
+#ifndef __POINT_LOCATION_HPP__
+#define __POINT_LOCATION_HPP__
+
+#include <cstdint>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+
+namespace bfreeman {
+
+enum PointClass {
+    POINT_INSIDE = 0,   // inside the boundary and outside every hole, so a valid query point
+    POINT_OUTSIDE = 1,  // outside the boundary
+    POINT_ON_EDGE = 2,  // on an edge of the boundary or of a hole (as in orientation and on_segment)
+    POINT_IN_HOLE = 3   // strictly inside a hole
+};
+
+struct PointLocation {
+    PointClass point_class;
+
+    // for POINT_ON_EDGE, the edge from polygon[ring][edge] to the vertex after it
+    size_t ring;
+    size_t edge;
+};
+
+enum EndpointPolicy {
+    TRUST_ENDPOINTS = 0,   // assume start and end are POINT_INSIDE, as dijkstra_path does
+    REJECT_ENDPOINTS = 1,  // answer queries with a start or end not POINT_INSIDE with no path
+    SNAP_ENDPOINTS = 2     // move such points to the nearest point inside first (see PointLocator::snap)
+};
+
+/*
+ * The boundary and hole edges of a polygon bucketed into
+ * horizontal bands, each listing the edges whose y ranges
+ * overlap it sorted by their smallest x. A point is located by
+ * casting a ray from it to the right through the edges of its
+ * band only: the first edge the ray crosses belongs to the ring
+ * nearest the point on that side, and which way that edge runs
+ * tells whether the point is inside that ring. Nothing else is
+ * counted, so a query stops at the first edge crossed instead of
+ * testing every edge of the polygon, and allocates nothing.
+ *
+ * Rings may be wound either way. The same polygon assumptions
+ * as dijkstra_path apply. Queries are const and may be run
+ * concurrently.
+ */
+class PointLocator {
+public:
+    PointLocator() = default;
+
+    explicit PointLocator(const std::vector<std::vector<Point>>& polygon);
+
+    PointLocation locate(const Point& point) const;
+
+    /*
+     * Moves point, if it is not POINT_INSIDE, onto the nearest
+     * point of the ring it is outside of (the boundary, or the
+     * hole it is in) and then off that edge into the polygon by
+     * just enough for locate to find it inside. Only the bands
+     * that may hold a nearer edge are searched.
+     *
+     * @return false if no point inside was found (point is then
+     *         unchanged)
+     */
+    bool snap(Point& point) const;
+
+    /*
+     * Applies policy to a query endpoint
+     *
+     * @return false if the query should be answered with no path
+     */
+    bool resolve(Point& point, const EndpointPolicy policy) const;
+
+private:
+    // an edge copied into each band it overlaps
+    struct BandEdge {
+        Segment segment;
+        double min_x;
+        uint32_t edge;
+    };
+
+    // the band holding y, clamped to the bands
+    size_t band_idx(const double y) const;
+
+    /*
+     * Calls visit(band_edge) for the edges of the bands around
+     * point, nearest band first, until every band that could
+     * hold a point nearer than the distance visit last returned
+     * has been visited
+     */
+    template<typename Visit>
+    void visit_nearby(const Point& point, Visit visit) const;
+
+    std::vector<Segment> edges;
+
+    // ring_of[e] is the ring edge e belongs to, first_edge[i] the first edge of ring i
+    std::vector<uint32_t> ring_of;
+    std::vector<size_t> first_edge;
+
+    // true for the rings wound counterclockwise
+    std::vector<bool> counterclockwise;
+
+    Point min;
+    Point max;
+    double band_height = 1;
+    size_t bands = 0;
+
+    // the edges of band b are band_edges[band_offsets[b]]...[band_offsets[b + 1] - 1]
+    std::vector<size_t> band_offsets;
+    std::vector<BandEdge> band_edges;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __POINT_LOCATION_HPP__
\ No newline at end of file
@@ -0,0 +1,198 @@
+#ifndef __POLYGON_GEOMETRY_HPP__
+#define __POLYGON_GEOMETRY_HPP__
+
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_batch.hpp"
+#include "edge_grid.hpp"
+
+namespace bfreeman {
+
+const double ORIENTATION_EPSILON = 10e-7;
+const IndexPair START_IDXP = {START_IDX, START_IDX, true};
+const IndexPair END_IDXP = {END_IDX, END_IDX, true};
+
+enum Orientation {
+    COLINEAR = 0,
+    COUNTERCLOCKWISE = 1,
+    CLOCKWISE = 2
+};
+
+bool is_close(const double a, const double b);
+
+/*
+ * Exact for integer coordinates, within ORIENTATION_EPSILON otherwise
+ */
+template<typename T>
+bool operator==(const BasicPoint<T>& p, const BasicPoint<T>& q);
+
+void operator-=(Point& p, const Point& q);
+
+double sq(const double d);
+
+template<typename T>
+typename ScalarTraits<T>::Distance length(const BasicSegment<T>& seg);
+
+bool is_neighbor_idx(size_t i, size_t j, const size_t size);
+
+template<typename T>
+Orientation orientation(const BasicPoint<T>& p, const BasicPoint<T>& q, const BasicPoint<T>& r);
+
+template<typename T>
+bool share_endpoint(const BasicSegment<T>& seg1, const BasicSegment<T>& seg2);
+
+template<typename T>
+bool on_segment(const BasicSegment<T>& seg, const BasicPoint<T>& p);
+
+template<typename T>
+bool check_intersect(const BasicSegment<T>& seg1, const BasicSegment<T>& seg2);
+
+/*
+ * @return the (positive) angle formed between the x-axis
+ *         and the line between origin and angle_point
+ */
+double get_relative_angle(const Point& origin, Point angle_point);
+
+/*
+ * @return uses the Point struct (two doubles packaged together)
+ *         to return two radian values that represent the valid
+ *         interior angle range for a point (i.e. lines coming off
+ *         of the point at those angles will start inside the polygon)
+ */
+Point get_angle_range(const std::vector<std::vector<Point>>& polygon, const IndexPair& idxp);
+
+bool pointing_inside(Segment segment, const Point& angle_range);
+
+/*
+ * The directions in which a chord can leave a vertex into the
+ * interior of the polygon: counterclockwise from the ray through
+ * from to the ray through to, both rays included. Testing a
+ * direction against it takes two orientation calls and no trig.
+ */
+template<typename T>
+struct BasicVertexCone {
+    BasicPoint<T> vertex;
+    BasicPoint<T> from;
+    BasicPoint<T> to;
+    bool convex; // spans at most half a turn
+};
+
+using VertexCone = BasicVertexCone<double>;
+
+template<typename T>
+BasicVertexCone<T> get_vertex_cone(const std::vector<std::vector<BasicPoint<T>>>& polygon, const IndexPair& idxp);
+
+/*
+ * @return the VertexCone of every vertex, in node order
+ *         without the start and end points
+ */
+template<typename T>
+std::vector<BasicVertexCone<T>> get_vertex_cones(const std::vector<std::vector<BasicPoint<T>>>& polygon);
+
+/*
+ * @return true if the chord from the vertex of cone to point
+ *         starts inside the polygon, false otherwise; the same
+ *         test as pointing_inside with get_angle_range
+ */
+template<typename T>
+bool pointing_inside(const BasicVertexCone<T>& cone, const BasicPoint<T>& point);
+
+/*
+ * @return true if the vertex at idxp is reflex as seen from
+ *         the interior of the polygon (i.e., a reflex vertex of
+ *         the boundary or a convex vertex of a hole), false
+ *         otherwise; shortest paths only bend at such vertices
+ */
+template<typename T>
+bool is_reflex_vertex(const std::vector<std::vector<BasicPoint<T>>>& polygon, const IndexPair& idxp);
+
+/*
+ * @return true if the line through the vertex at idxp and
+ *         other does not separate the two neighbors of the
+ *         vertex (i.e., it touches the polygon at the vertex)
+ */
+template<typename T>
+bool is_tangent(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const IndexPair& idxp,
+        const BasicPoint<T>& other
+);
+
+/*
+ * @return true if a chord (know to contain at least one
+ *         of the start or end points) is interior to
+ *         the polygon, false otherwise
+ */
+template<typename T>
+bool is_interior_chord_start_or_end(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const BasicSegment<T>& segment
+);
+
+/*
+ * Same as above, testing only the edges an EdgeGrid
+ * over the polygon finds near the chord
+ */
+bool is_interior_chord_start_or_end(const EdgeGrid& edge_grid, const Segment& segment);
+
+/*
+ * Same as above, testing every edge of an EdgeBatch
+ * over the polygon several edges at a time
+ */
+bool is_interior_chord_start_or_end(const EdgeBatch& edge_batch, const Segment& segment);
+
+/*
+ * @return true if a chord (know to not contain
+ *         the start or end points) is interior to
+ *         the polygon, false otherwise
+ */
+template<typename T>
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const IndexPair& from,
+        const IndexPair& to
+);
+
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeGrid& edge_grid,
+        const IndexPair& from,
+        const IndexPair& to
+);
+
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeBatch& edge_batch,
+        const IndexPair& from,
+        const IndexPair& to
+);
+
+/*
+ * Populates an adjacency list row with the chords between
+ * the vertex at idxp and every other vertex of the polygon
+ * (i.e., chords containing neither the start or end point)
+ */
+template<typename T>
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        std::vector<BasicEdge<T>>& adj_list_row,
+        const IndexPair idxp
+);
+
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeGrid& edge_grid,
+        std::vector<Edge>& adj_list_row,
+        const IndexPair idxp
+);
+
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeBatch& edge_batch,
+        std::vector<Edge>& adj_list_row,
+        const IndexPair idxp
+);
+
+} // namespace bfreeman
+
+#endif // #ifndef __POLYGON_GEOMETRY_HPP__
\ No newline at end of file
@@ -0,0 +1,584 @@
+#ifndef __POLYGON_INDEX_HPP__
+#define __POLYGON_INDEX_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_batch.hpp"
+#include "edge_grid.hpp"
+#include "index_file.hpp"
+#include "indexed_heap.hpp"
+#include "obstacle_set.hpp"
+#include "point_location.hpp"
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+enum VisibilityEngine {
+    BRUTE_FORCE = 0,      // test every vertex pair against every edge, O(n^3)
+    ROTATIONAL_SWEEP = 1  // Lee's rotational sweep around each vertex, O(n^2 log n)
+};
+
+struct IndexOptions {
+    // worker threads building the graph, 0 for one per hardware thread
+    size_t threads = 1;
+
+    // test chords only against nearby edges found through an EdgeGrid
+    bool edge_grid = true;
+
+    // how the chords between the vertices are found
+    VisibilityEngine engine = BRUTE_FORCE;
+
+    /*
+     * keep only the reflex vertices (see is_reflex_vertex) and the
+     * chords tangent to the polygon at both ends; shortest paths
+     * are unchanged, but the graph is much smaller on maps with
+     * mostly convex corners
+     */
+    bool reduced = false;
+
+    /*
+     * also search from every vertex (across threads) and keep the
+     * distance and next hop between every pair of vertices, which
+     * takes 12 bytes per pair; TABLE_LOOKUP queries then need no
+     * search at all
+     */
+    bool all_pairs = false;
+
+    // if not null, counts the work of building the graph (see query_stats.hpp)
+    QueryStats* stats = nullptr;
+};
+
+enum SearchAlgorithm {
+    DIJKSTRA = 0,  // expands nodes in order of their distance from start
+    A_STAR = 1,    // expands nodes in order of distance from start plus straight-line distance to end
+    TABLE_LOOKUP = 2  // joins the vertices start and end see through the all-pairs table, if it was built
+};
+
+struct QueryOptions {
+    SearchAlgorithm search = DIJKSTRA;
+
+    /*
+     * if not null and not empty, PolygonIndex queries also keep
+     * out of these obstacles; a search tests each edge against
+     * them only once relaxing it would shorten a path, leaving
+     * the shared graph untouched. Paths still only bend at the
+     * vertices of the polygon, so may be longer than the shortest
+     * path around an obstacle, or not found at all. A
+     * TABLE_LOOKUP falls back to Dijkstra's algorithm.
+     */
+    const ObstacleSet* obstacles = nullptr;
+
+    /*
+     * what to do with a start or end point that is not inside
+     * the polygon (see PointLocator::locate), which the searches
+     * otherwise assume: a rejected query is answered with an
+     * empty path and a distance of __DBL_MAX__, and a snapped
+     * point replaces the original in the path
+     */
+    EndpointPolicy endpoints = TRUST_ENDPOINTS;
+
+    // if not null, counts the work of the query (see query_stats.hpp)
+    QueryStats* stats = nullptr;
+};
+
+/*
+ * A graph in compressed sparse row form: the edges of node n
+ * lead to nodes targets[k] and have lengths weights[k] for
+ * offsets[n] <= k < offsets[n + 1]. Keeping every edge in a
+ * few flat arrays makes a search read memory in order instead
+ * of chasing one heap allocation per row.
+ */
+struct CompactGraph {
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<double> weights;
+};
+
+/*
+ * The arrays of a CompactGraph wherever they are kept: in the
+ * CompactGraph a PolygonIndex built, or in the file a loaded
+ * PolygonIndex maps (see PolygonIndex::load)
+ */
+struct CompactGraphView {
+    const size_t* offsets;
+    const uint32_t* targets;
+    const double* weights;
+    size_t node_count;
+    size_t edge_count;
+};
+
+/*
+ * The shortest paths from one start point to every vertex of
+ * a PolygonIndex (see PolygonIndex::shortest_path_tree)
+ */
+struct ShortestPathTree {
+    Point start;
+
+    // the length of the shortest path from start to node idx, __DBL_MAX__ if there is none
+    std::vector<double> distances;
+
+    // the node before node idx on that path
+    std::vector<uint32_t> prev;
+};
+
+// an edge of a query (or of a graph row being built), leading to node idx
+struct NodeEdge {
+    uint32_t idx;
+    double distance;
+};
+
+// which vertices the start and end points of a query can see
+struct QueryEdges {
+    std::vector<NodeEdge> start_edges;
+    std::vector<NodeEdge> end_edges;
+    std::vector<bool> sees_start;
+    std::vector<bool> sees_end;
+    double start_end_distance;
+    bool start_sees_end;
+};
+
+// the search state of a TriangulationIndex query (see triangulation_index.hpp)
+struct TriangulationScratch;
+
+/*
+ * Scratch space for the queries of a PolygonIndex or a
+ * TriangulationIndex. Queries passed a QueryContext clear its
+ * arrays instead of freeing them, so once a context has served
+ * a query as large as the current one, the query allocates no
+ * memory at all. Keep one per thread; a context must not be
+ * used by two queries at once.
+ */
+struct QueryContext {
+    QueryContext();
+    QueryContext(QueryContext&& other) noexcept;
+    QueryContext& operator=(QueryContext&& other) noexcept;
+    ~QueryContext();
+
+    // the answer to the last query run with this context
+    DijkstraData result;
+
+    // the rest is only kept for its capacity
+    QueryEdges query_edges;
+    IndexedHeap heap;
+    std::vector<double> distances;
+    std::vector<uint32_t> prev;
+
+    // made by the first TriangulationIndex query run with this context
+    std::unique_ptr<TriangulationScratch> triangulation;
+
+    /*
+     * the goals of a nearest_goal query in the order they are
+     * connected, and their edges as a list per node they leave:
+     * goal_edge_head[idx] is the last edge added from node idx
+     * and goal_edge_next[k] the one added before edge k
+     */
+    std::vector<Point> goals;
+    std::vector<uint32_t> goal_order;
+    std::vector<NodeEdge> goal_edges;
+    std::vector<uint32_t> goal_edge_next;
+    std::vector<uint32_t> goal_edge_head;
+};
+
+// the goal index nearest_goal returns when no goal can be reached
+const size_t NO_GOAL = SIZE_MAX;
+
+/*
+ * The shortest path from a start point to the nearest of
+ * several goals (see PolygonIndex::nearest_goal)
+ */
+struct GoalPath {
+    DijkstraData dijkstra_data;
+
+    // the index in goals of the goal the path leads to, or NO_GOAL
+    size_t goal;
+};
+
+/*
+ * A polygon together with the part of its graph that does
+ * not depend on the start and end points (i.e., the chords
+ * between its vertices). Building the index is the expensive
+ * step; each query afterwards only needs to connect its start
+ * and end points to the cached graph before searching it.
+ *
+ * Nodes are numbered as in generate_adjacency_list:
+ * [0] = start, [1] = end, [2]... = boundary, then holes.
+ *
+ * The chords are stored as a CompactGraph over these node
+ * indices, so a polygon may have at most 2^32 - 2 vertices.
+ *
+ * The same polygon assumptions as dijkstra_path apply.
+ * Queries are const and may be run concurrently.
+ *
+ * Holes can be added and removed and vertices moved without
+ * building the index again: an update re-tests the chords of
+ * the vertices whose corners it changes, and in every other
+ * row only the chords whose bounding boxes come near an edge
+ * it added or removed. The graph ends up exactly as a new
+ * index over the updated polygon would build it. Updates are
+ * not const, so must not run concurrently with queries.
+ */
+class PolygonIndex {
+public:
+    explicit PolygonIndex(
+            const std::vector<std::vector<Point>>& polygon,
+            const IndexOptions& options = IndexOptions()
+    );
+
+    /*
+     * @return the same adjacency list generate_adjacency_list
+     *         would return for the indexed polygon
+     */
+    std::vector<std::vector<Edge>> adjacency_list(const Point& start, const Point& end) const;
+
+    /*
+     * Both searches stop as soon as end is reached. A* usually
+     * expands far fewer nodes, but may pick a different path
+     * when several paths have the same length. So may a
+     * TABLE_LOOKUP, which falls back to Dijkstra's algorithm
+     * if the index was built without IndexOptions::all_pairs.
+     *
+     * @return the same DijkstraData dijkstra_path would
+     *         return for the indexed polygon
+     */
+    DijkstraData dijkstra_path(
+            const Point& start,
+            const Point& end,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Same as above, working in context instead of allocating
+     *
+     * @return context.result, valid until context is next used
+     */
+    const DijkstraData& dijkstra_path(
+            const Point& start,
+            const Point& end,
+            QueryContext& context,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Runs dijkstra_path for every (start, end) pair in queries
+     * across a pool of worker threads (one per hardware thread
+     * if threads is 0).
+     *
+     * @return one DijkstraData per query, in the order of queries
+     */
+    std::vector<DijkstraData> dijkstra_paths(
+            const std::vector<std::pair<Point, Point>>& queries,
+            const size_t threads = 0,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Finds the goal with the shortest path from start in a
+     * single search: each goal becomes a node of its own, joined
+     * to the vertices it sees (as end is in dijkstra_path), and
+     * Dijkstra's algorithm runs from start until the first goal
+     * is settled. A goal is only connected once the search has
+     * reached its straight-line distance from start, which no
+     * path to it can be shorter than, so goals farther away than
+     * the nearest one's path length are never connected at all.
+     * options.search is ignored, as A* needs a single end point,
+     * and goals options.endpoints rejects are skipped.
+     *
+     * @return the path to the nearest goal (ties going to either)
+     *         and its index in goals, or NO_GOAL with an empty
+     *         path and a distance of __DBL_MAX__ if no goal can
+     *         be reached
+     */
+    GoalPath nearest_goal(
+            const Point& start,
+            const std::vector<Point>& goals,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Same as above, working in context instead of allocating
+     *
+     * @return the index of the nearest goal, or NO_GOAL; the path
+     *         to it is left in context.result
+     */
+    size_t nearest_goal(
+            const Point& start,
+            const std::vector<Point>& goals,
+            QueryContext& context,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Searches from start until every vertex is reached, which
+     * costs about as much as one dijkstra_path call. Paths from
+     * start to any number of end points can then be read off the
+     * tree, each only testing which vertices its end point sees.
+     * options.search is ignored, as A* needs an end point. If
+     * options.endpoints rejects start, every vertex is left
+     * unreached, and if it snaps start, tree.start is the
+     * snapped point.
+     */
+    ShortestPathTree shortest_path_tree(
+            const Point& start,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * options.obstacles and options.endpoints must be those
+     * the tree was built with.
+     *
+     * @return the same DijkstraData dijkstra_path would return
+     *         from tree.start to end with a Dijkstra search
+     */
+    DijkstraData tree_path(
+            const ShortestPathTree& tree,
+            const Point& end,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Same as above, working in context instead of allocating
+     *
+     * @return context.result, valid until context is next used
+     */
+    const DijkstraData& tree_path(
+            const ShortestPathTree& tree,
+            const Point& end,
+            QueryContext& context,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Runs tree_path from tree for every end point in ends
+     * across a pool of worker threads (one per hardware thread
+     * if threads is 0).
+     *
+     * @return one DijkstraData per end point, in the order of ends
+     */
+    std::vector<DijkstraData> tree_paths(
+            const ShortestPathTree& tree,
+            const std::vector<Point>& ends,
+            const size_t threads = 0,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Writes the polygon, the graph and the all-pairs table (if
+     * any) to a binary file at path (see IndexFileHeader), which
+     * load maps back in without rebuilding anything
+     */
+    IndexFileStatus save(const std::string& path) const;
+
+    /*
+     * Maps a file written by save into memory and sets index to
+     * an index whose graph and all-pairs table are read straight
+     * from the mapping, so loading takes time and memory linear
+     * in the number of vertices, however many chords there are.
+     * The mapping lives as long as the index (or any copy of it).
+     *
+     * verify_checksum reads the whole file once to check it; a
+     * file that is trusted can skip this to only page in the
+     * parts queries touch.
+     *
+     * @return INDEX_FILE_OK, or why the file was rejected (index
+     *         is then left unchanged)
+     */
+    static IndexFileStatus load(
+            const std::string& path,
+            std::unique_ptr<PolygonIndex>& index,
+            const bool verify_checksum = true
+    );
+
+    /*
+     * Adds hole (wound counterclockwise) as the last ring of the
+     * polygon, so the node indices of the other vertices stay the
+     * same, and updates the graph (and all-pairs table, if any)
+     * across worker_count(threads) threads.
+     *
+     * @return false if hole has fewer than 3 vertices
+     *         (the index is then unchanged)
+     */
+    bool insert_hole(const std::vector<Point>& hole, const size_t threads = 1);
+
+    /*
+     * Removes ring i (a hole, so i >= 1) of the polygon, which
+     * moves the vertices of the holes after it down to lower
+     * node indices, and updates the graph as above.
+     *
+     * @return false if there is no hole i (the index is then unchanged)
+     */
+    bool remove_hole(const size_t i, const size_t threads = 1);
+
+    /*
+     * Moves the vertex at idxp to point, which must leave the
+     * polygon simple, and updates the graph as above.
+     *
+     * @return false if there is no vertex at idxp
+     *         (the index is then unchanged)
+     */
+    bool move_vertex(const IndexPair& idxp, const Point& point, const size_t threads = 1);
+
+    const std::vector<std::vector<Point>>& get_polygon() const;
+
+    /*
+     * @return where point is relative to the polygon, in about
+     *         the square root of the number of edges steps
+     */
+    PointLocation locate(const Point& point) const;
+
+    /*
+     * @return the vertex-vertex chords, in which the rows of
+     *         start and end are empty; adjacency_list converts
+     *         them (with a query's edges) to the Edge form
+     */
+    CompactGraphView get_graph() const;
+
+    /*
+     * @return the length of the shortest path between the
+     *         vertices at node indices idx1 and idx2, or
+     *         __DBL_MAX__ if there is none (or no all-pairs
+     *         table was built)
+     */
+    double get_vertex_distance(const size_t idx1, const size_t idx2) const;
+
+    /*
+     * @return the number of graph nodes, including start and end
+     */
+    size_t get_node_count() const;
+
+    /*
+     * @return the node index of the vertex pointed to by idxp
+     */
+    size_t get_node_idx(const IndexPair& idxp) const;
+
+    /*
+     * @return the IndexPair of the vertex at node index idx
+     */
+    IndexPair get_idxp(const size_t idx) const;
+
+private:
+    // the parts of an index that only depend on the polygon, without any chords
+    PolygonIndex(const std::vector<std::vector<Point>>& polygon, const bool use_edge_grid, const bool reduced);
+
+    // finds the edges from point to the vertices it sees, replacing any in point_edges and sees_point
+    void connect_point(const Point& point, std::vector<NodeEdge>& point_edges, std::vector<bool>& sees_point) const;
+
+    void connect(const Point& start, const Point& end, QueryEdges& query_edges) const;
+
+    /*
+     * Dijkstra's algorithm (or A*) from source (start unless it is
+     * a vertex) over the graph and query_edges, stopping once end
+     * is settled if it is reached, and skipping the edges obstacles
+     * (if not null) blocks
+     */
+    void search(
+            const size_t source,
+            const QueryEdges& query_edges,
+            const Point& start,
+            const Point& end,
+            const bool a_star,
+            const ObstacleSet* obstacles,
+            IndexedHeap& point_queue,
+            std::vector<double>& distances,
+            std::vector<uint32_t>& prev_point_in_shortest_path
+    ) const;
+
+    // the bounding box of some edges an update adds or removes, and the length of the shortest
+    struct ChangedRegion {
+        Point min;
+        Point max;
+        double shortest_edge;
+    };
+
+    static ChangedRegion changed_region(const std::vector<Segment>& edges);
+
+    /*
+     * @return true if check_intersect may find the chord from a
+     *         to b crossing an edge in region, false if it cannot
+     */
+    static bool near_region(const Point& a, const Point& b, const ChangedRegion& region);
+
+    /*
+     * Replaces the polygon with new_polygon and the graph with
+     * the one a new index would build over it. Vertex node idx
+     * is at node new_node_idx[idx] afterwards (UINT32_MAX if it
+     * was removed). The rows of the vertices in dirty_nodes (new
+     * node indices) and of the vertices with no old node index
+     * are built again; the other rows only re-test their chords
+     * to those vertices, their old chords near added_regions and
+     * the other pairs near removed_regions.
+     */
+    void update(
+            const std::vector<std::vector<Point>>& new_polygon,
+            const std::vector<uint32_t>& new_node_idx,
+            const std::vector<size_t>& dirty_nodes,
+            const std::vector<ChangedRegion>& added_regions,
+            const std::vector<ChangedRegion>& removed_regions,
+            const size_t threads
+    );
+
+    // true if the chord from idxp (whose cone is cone) to idxp_other would be in a newly built row of idxp
+    bool keeps_chord(const IndexPair& idxp, const VertexCone& cone, const IndexPair& idxp_other) const;
+
+    // packs the rows (of every vertex, in node order) into a new graph, building an all-pairs table if asked
+    void set_graph(std::vector<std::vector<NodeEdge>>& vertex_adjacency, const bool all_pairs, const size_t threads);
+
+    // searches from every vertex to fill an all-pairs table (see all_pairs_distances)
+    void build_all_pairs(const size_t threads, std::vector<double>& distances, std::vector<uint32_t>& next) const;
+
+    // joins start and end through the all-pairs table into context.result
+    void table_lookup(const Point& start, const Point& end, QueryContext& context) const;
+
+    // sets dijkstra_path to the path from start through the vertices before backtrack_idx (a vertex or start) to end
+    void reconstruct_path(
+            const std::vector<uint32_t>& prev_point_in_shortest_path,
+            size_t backtrack_idx,
+            const Point& start,
+            const Point& end,
+            std::vector<Point>& dijkstra_path
+    ) const;
+
+    // is_interior_chord_start_or_end through the grid if it is used, else every edge
+    bool is_interior_chord(const Segment& segment) const;
+
+    // drops the edges of node idx that a reduced graph does not keep
+    void reduce_row(std::vector<Edge>& adj_list_row, const size_t idx) const;
+
+    std::vector<std::vector<Point>> polygon;
+    EdgeGrid edge_grid;
+    EdgeBatch edge_batch;
+    PointLocator point_locator;
+    bool use_edge_grid;
+    bool reduced;
+
+    // reflex[idx - 2] is false for vertices left out of a reduced graph
+    std::vector<bool> reflex;
+
+    // node index of the first vertex of each ring (boundary, then holes)
+    std::vector<size_t> ring_offsets;
+
+    // vertices[idx - 2] is the vertex at node index idx
+    std::vector<Point> vertices;
+
+    // keeps the arrays below alive: the graph and table this index built, or the file it mapped
+    std::shared_ptr<const void> storage;
+
+    CompactGraphView graph;
+
+    /*
+     * with an all-pairs table over n vertices, entry
+     * [(idx2 - 2) * n + idx1 - 2] holds the distance between the
+     * vertices at node indices idx1 and idx2 and the node after
+     * idx1 on a shortest path from idx1 to idx2; row idx2 - 2 is
+     * filled by one search from idx2 (both null without a table)
+     */
+    const double* all_pairs_distances;
+    const uint32_t* all_pairs_next;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __POLYGON_INDEX_HPP__
\ No newline at end of file
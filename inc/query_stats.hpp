@@ -0,0 +1,124 @@
+#ifndef __QUERY_STATS_HPP__
+#define __QUERY_STATS_HPP__
+
+#include <cstddef>
+
+namespace bfreeman {
+
+/*
+ * Counts the work done building a graph and searching it. The
+ * counters are only kept when the library is compiled with
+ * DIJKSTRA_POLYGON_STATS defined (the CMake option of the same
+ * name); otherwise the hooks below do nothing and a QueryStats
+ * passed in is left untouched.
+ *
+ * Stats are added to, never reset, so one QueryStats can total
+ * a batch of queries. Work split across worker threads is
+ * counted per thread and added up once the workers are done;
+ * the timings of such work are then summed over the threads.
+ */
+struct QueryStats {
+    // segment-edge tests, each edge of a SIMD batch counting as one
+    size_t check_intersect_calls = 0;
+
+    // candidate chords found inside or outside the polygon
+    size_t chords_accepted = 0;
+    size_t chords_rejected = 0;
+
+    // graph and query edges a search skipped as they touch a QueryOptions::obstacles polygon
+    size_t edges_blocked = 0;
+
+    size_t heap_pushes = 0;
+    size_t heap_pops = 0;
+    size_t nodes_settled = 0;
+
+    // building the vertex-vertex chords and connecting start and end to them
+    double build_seconds = 0;
+    double search_seconds = 0;
+    double reconstruction_seconds = 0;
+};
+
+void operator+=(QueryStats& stats, const QueryStats& other);
+
+/*
+ * The classes below have the same members whatever
+ * DIJKSTRA_POLYGON_STATS is set to, so code built with and
+ * without the option agrees on their layout. With the option
+ * their bodies are in query_stats.cpp; without it they are
+ * empty inline functions here that compile to nothing, and
+ * thread_stats is never set.
+ */
+
+// the QueryStats the current thread counts into, if any
+extern thread_local QueryStats* thread_stats;
+
+#ifdef DIJKSTRA_POLYGON_STATS
+#define STATS_ADD(counter, n) \
+    do { if (bfreeman::thread_stats) bfreeman::thread_stats->counter += (n); } while (0)
+#else
+#define STATS_ADD(counter, n) do {} while (0)
+#endif // #ifdef DIJKSTRA_POLYGON_STATS
+
+inline QueryStats* current_stats() {
+    return thread_stats;
+}
+
+/*
+ * Makes the current thread count into stats until the scope
+ * ends. A null stats leaves the enclosing scope in place.
+ */
+class StatsScope {
+public:
+    explicit StatsScope(QueryStats* stats);
+    ~StatsScope();
+
+private:
+    QueryStats* previous;
+};
+
+/*
+ * Adds the wall time from its construction to its destruction
+ * to the given timing of the QueryStats of the current thread
+ */
+class StatsTimer {
+public:
+    explicit StatsTimer(double QueryStats::* seconds);
+    ~StatsTimer();
+
+    // adds the time so far now instead of on destruction
+    void stop();
+
+private:
+    double QueryStats::* seconds;
+    double start;
+    bool stopped;
+};
+
+/*
+ * Counts a candidate chord as accepted or rejected
+ *
+ * @return accepted
+ */
+inline bool count_chord(const bool accepted) {
+    STATS_ADD(chords_accepted, accepted);
+    STATS_ADD(chords_rejected, !accepted);
+    return accepted;
+}
+
+#ifndef DIJKSTRA_POLYGON_STATS
+
+inline StatsScope::StatsScope(QueryStats*) : previous(nullptr) {}
+
+inline StatsScope::~StatsScope() {}
+
+inline StatsTimer::StatsTimer(double QueryStats::* seconds) : seconds(seconds), start(0), stopped(true) {}
+
+inline StatsTimer::~StatsTimer() {}
+
+inline void StatsTimer::stop() {}
+
+#endif // #ifndef DIJKSTRA_POLYGON_STATS
+
+} // namespace bfreeman
+
+#endif // #ifndef __QUERY_STATS_HPP__
\ No newline at end of file
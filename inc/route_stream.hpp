@@ -0,0 +1,89 @@
+#ifndef __ROUTE_STREAM_HPP__
+#define __ROUTE_STREAM_HPP__
+
+#include <cstddef>
+#include "dijkstra_polygon.hpp"
+#include "polygon_index.hpp"
+#include "triangulation_index.hpp"
+
+namespace bfreeman {
+
+enum StreamFormat {
+    /*
+     * One query per line, "start.x start.y end.x end.y" (spaces,
+     * tabs or commas between the numbers). Empty lines and lines
+     * starting with // are skipped. Each query is answered by one
+     * line, "distance count x1 y1 ... x_count y_count", with every
+     * number written so it reads back to the same double, or by
+     * "error" if the line is not four numbers.
+     */
+    TEXT_STREAM = 0,
+
+    /*
+     * Each query is four doubles (start.x, start.y, end.x, end.y),
+     * answered by the distance as a double, the point count as a
+     * uint64_t and then the points as pairs of doubles. Everything
+     * is in the byte order of the machine running the stream.
+     */
+    BINARY_STREAM = 1
+};
+
+enum StreamStatus {
+    STREAM_OK = 0,
+    STREAM_READ_ERROR = 1,   // reading in_fd failed, or it ended partway through a binary query
+    STREAM_WRITE_ERROR = 2   // writing out_fd failed, so the stream stopped early
+};
+
+struct StreamOptions {
+    StreamFormat format = TEXT_STREAM;
+
+    // worker threads answering queries, or 0 for one per hardware thread
+    size_t threads = 0;
+
+    // most queries handed to a worker at once
+    size_t batch_size = 256;
+
+    // passed to every query; its stats add up the work of all the workers
+    QueryOptions query;
+};
+
+/*
+ * Answers the queries read from in_fd, writing the answers to
+ * out_fd in the order the queries came in, until in_fd ends.
+ *
+ * Reading, answering and writing run on separate threads: the
+ * calling thread reads and parses batches of queries, the
+ * workers answer them (each with a QueryContext of its own) and
+ * format the answers, and one more thread writes the formatted
+ * batches in order. A batch is cut short whenever a read returns
+ * less than was asked for, so a client waiting for each answer
+ * before sending its next query is not kept waiting, while a
+ * busy stream is read in full batches. At most a few batches
+ * per worker are in flight, so memory stays bounded when out_fd
+ * is slower than the queries.
+ *
+ * Neither descriptor is closed.
+ *
+ * @return STREAM_OK once every query has been answered, or the
+ *         error that stopped the stream
+ */
+StreamStatus route_stream(
+        const PolygonIndex& index,
+        const int in_fd,
+        const int out_fd,
+        const StreamOptions& options = StreamOptions()
+);
+
+/*
+ * Same as above, answering the queries through a TriangulationIndex
+ */
+StreamStatus route_stream(
+        const TriangulationIndex& index,
+        const int in_fd,
+        const int out_fd,
+        const StreamOptions& options = StreamOptions()
+);
+
+} // namespace bfreeman
+
+#endif // #ifndef __ROUTE_STREAM_HPP__
\ No newline at end of file
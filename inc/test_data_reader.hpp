@@ -1,6 +1,11 @@
 #ifndef __TEST_DATA_READER_HPP__
 #define __TEST_DATA_READER_HPP__
 
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "test_util.hpp"
+
 enum ReadType {
     SHAPE = 0,
     START_END = 1,
@@ -15,4 +20,39 @@ enum ReadType {
  */
 void* read_test_data(const ReadType type, const std::string& name, const size_t size);
 
+/*
+ * Every section of a test file.
+ */
+struct TestData {
+    Polygon polygon;
+    PointPair start_end;
+    AdjacencyList adjacency_list;
+    double path_length;
+    std::vector<bfreeman::Point> path_points;
+};
+
+enum TestDataStatus {
+    TEST_DATA_OK = 0,
+    TEST_DATA_IO_ERROR = 1,  // the file could not be opened or mapped
+    TEST_DATA_BAD_LINE = 2   // a line does not hold what its section does
+};
+
+/*
+ * @return the path of the test file of the given name
+ */
+std::string test_data_path(const std::string& name);
+
+/*
+ * Reads every section of the test file at path in one pass over
+ * the file mapped into memory, parsing numbers in place, so that
+ * large corpora load in time linear in their size. Polygon rings
+ * and adjacency list rows are added as their indices come up, so
+ * no sizes need to be known in advance.
+ *
+ * @return TEST_DATA_OK, or why the file was not read (data is then
+ *         partly filled in, and bad_line, if given, is set to the
+ *         1-based number of the line that could not be read)
+ */
+TestDataStatus load_test_data(const std::string& path, TestData& data, size_t* bad_line = nullptr);
+
 #endif // #ifndef __TEST_DATA_READER_HPP__
\ No newline at end of file
@@ -30,6 +30,37 @@ void run_test(
         const bool verbose
 );
 
+/*
+ * Same as run_test, but only compares the paths, for graphs that
+ * are not expected to match the adjacency list in the test file.
+ */
+void run_path_test(
+        std::string name,
+        const Polygon& polygon,
+        const double test_path_length,
+        const double true_path_length,
+        const std::vector<bfreeman::Point>& test_path_points,
+        const std::vector<bfreeman::Point>& true_path_points,
+        unsigned short& passed_tests,
+        const bool verbose
+);
+
+/*
+ * Same as run_path_test, but accepts any path of the right length
+ * between the right end points, for engines that may break ties
+ * between equally short paths differently.
+ */
+void run_length_test(
+        std::string name,
+        const Polygon& polygon,
+        const double test_path_length,
+        const double true_path_length,
+        const std::vector<bfreeman::Point>& test_path_points,
+        const std::vector<bfreeman::Point>& true_path_points,
+        unsigned short& passed_tests,
+        const bool verbose
+);
+
 /*
  * Prints a fraction and percentage of tests passed.
  */
@@ -0,0 +1,43 @@
+#ifndef __TRIANGULATION_HPP__
+#define __TRIANGULATION_HPP__
+
+#include <cstdint>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+
+namespace bfreeman {
+
+const uint32_t NO_NEIGHBOR = UINT32_MAX;
+
+/*
+ * A triangle of a triangulated polygon, by the node indices of
+ * its vertices (numbered as in generate_adjacency_list) in
+ * counterclockwise order. neighbors[k] is the triangle across
+ * the edge from vertices[k] to vertices[(k + 1) % 3], or
+ * NO_NEIGHBOR if that edge is part of the polygon boundary or
+ * a hole.
+ */
+struct Triangle {
+    uint32_t vertices[3];
+    uint32_t neighbors[3];
+};
+
+/*
+ * Triangulates the interior of polygon (outside its holes) in
+ * O(n log n): a sweep line cuts it into pieces monotone from top
+ * to bottom, and each piece is triangulated in linear time. Edges
+ * are then flipped until the triangulation is Delaunay apart from
+ * the polygon edges, which avoids most of the long, thin
+ * triangles the sweep leaves.
+ *
+ * Every vertex is a corner of some triangle and triangles meet
+ * edge to edge, so a polygon of n vertices and h holes gives
+ * n + 2h - 2 triangles. The rings may be wound either way.
+ *
+ * The same polygon assumptions as dijkstra_path apply.
+ */
+std::vector<Triangle> triangulate(const std::vector<std::vector<Point>>& polygon);
+
+} // namespace bfreeman
+
+#endif // #ifndef __TRIANGULATION_HPP__
\ No newline at end of file
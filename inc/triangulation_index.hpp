@@ -0,0 +1,189 @@
+#ifndef __TRIANGULATION_INDEX_HPP__
+#define __TRIANGULATION_INDEX_HPP__
+
+#include <cstdint>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "polygon_index.hpp"
+#include "triangulation.hpp"
+
+namespace bfreeman {
+
+/*
+ * A search node of a TriangulationIndex query: the part of an
+ * edge of a triangle that can be seen from a root (the start, or
+ * a corner the path bends around) through the triangles before
+ * it, looking into the triangle. left and right are the ends of
+ * that part as seen from the root.
+ */
+struct IntervalNode {
+    Point left;
+    Point right;
+
+    // the node index of left or right if it is a vertex, UINT32_MAX otherwise
+    uint32_t left_vertex;
+    uint32_t right_vertex;
+
+    // the triangle looked into and its edge holding the interval, or UINT32_MAX for a path to end
+    uint32_t triangle;
+    uint32_t side;
+
+    // the root, as an index into TriangulationScratch::roots, and the length of the path to it
+    uint32_t root;
+    double g;
+};
+
+// a corner a TriangulationIndex path bends around, the root before it and the length of the path to it
+struct IntervalRoot {
+    Point point;
+    uint32_t vertex;
+    uint32_t parent;
+    double g;
+};
+
+// the arrays a TriangulationIndex query works in, kept in a QueryContext for their capacity
+struct TriangulationScratch {
+    std::vector<IntervalNode> intervals;
+    std::vector<IntervalRoot> roots;
+
+    // (g plus the estimate to end, index into intervals) as a heap
+    std::vector<std::pair<double, uint32_t>> interval_queue;
+
+    std::vector<uint32_t> start_triangles;
+    std::vector<uint32_t> end_triangles;
+};
+
+/*
+ * A polygon triangulated once (see triangulate), answering
+ * queries without any visibility graph: the triangles holding
+ * start and end are found, and A* runs from start over
+ * intervals of triangle edges, each the part of an edge seen
+ * from the last corner the path bent around, until it reaches
+ * the triangle holding end (the Polyanya search of Cui, Harabor
+ * and Grastien). Paths only bend around corners where the
+ * polygon is not convex, so the first path to end found is the
+ * shortest one, the same length dijkstra_path finds.
+ *
+ * Building the index is O(n log n) for typical polygons and a
+ * query only visits the triangles the search reaches, so this
+ * scales to polygons far too large for a PolygonIndex.
+ *
+ * The same polygon assumptions as dijkstra_path apply.
+ * Queries are const and may be run concurrently.
+ */
+class TriangulationIndex {
+public:
+    explicit TriangulationIndex(const std::vector<std::vector<Point>>& polygon);
+
+    /*
+     * options.search is ignored; the search is always A* over
+     * edge intervals.
+     *
+     * @return a DijkstraData as dijkstra_path would, or a path of
+     *         just start and end with a distance of __DBL_MAX__
+     *         if either is outside the polygon (unless
+     *         options.endpoints rejects or snaps them first)
+     */
+    DijkstraData dijkstra_path(
+            const Point& start,
+            const Point& end,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Same as above, working in context instead of allocating
+     *
+     * @return context.result, valid until context is next used
+     */
+    const DijkstraData& dijkstra_path(
+            const Point& start,
+            const Point& end,
+            QueryContext& context,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Runs dijkstra_path for every (start, end) pair in queries
+     * across a pool of worker threads (one per hardware thread
+     * if threads is 0).
+     *
+     * @return one DijkstraData per query, in the order of queries
+     */
+    std::vector<DijkstraData> dijkstra_paths(
+            const std::vector<std::pair<Point, Point>>& queries,
+            const size_t threads = 0,
+            const QueryOptions& options = QueryOptions()
+    ) const;
+
+    /*
+     * Only the triangles listed in the grid cell holding point
+     * are tested.
+     *
+     * @return the index of a triangle containing point (inside
+     *         or on its edges), or NO_NEIGHBOR if there is none
+     */
+    uint32_t locate(const Point& point) const;
+
+    const std::vector<Triangle>& get_triangles() const;
+
+private:
+    // the corner of a triangle at node index idx
+    const Point& vertex(const uint32_t idx) const;
+
+    /*
+     * Fills found with t and the other triangles holding point,
+     * which is in triangle t: those across an edge point is on
+     */
+    void containing_triangles(const Point& point, const uint32_t t, std::vector<uint32_t>& found) const;
+
+    /*
+     * Where the ray from root through a point of edge side of
+     * triangle t leaves t, root being on the other side of that
+     * edge: as 0 to 1 along the edge from the edge's first vertex
+     * a to the opposite vertex c, or 1 to 2 along the edge from c
+     * to the edge's second vertex b. through_vertex is the node
+     * index of through if it is a or b.
+     */
+    double project(
+            const Point& root,
+            const Point& through,
+            const uint32_t through_vertex,
+            const uint32_t t,
+            const uint32_t side
+    ) const;
+
+    // the column or row of the locate grid holding x or y, clamped to the grid
+    size_t cell_column(const double x) const;
+    size_t cell_row(const double y) const;
+
+    // vertices[idx - 2] is the vertex at node index idx
+    std::vector<Point> vertices;
+
+    std::vector<Triangle> triangles;
+
+    // corners[idx - 2] is true if the polygon is not convex at the vertex at node index idx
+    std::vector<bool> corners;
+
+    // applies QueryOptions::endpoints
+    PointLocator point_locator;
+
+    /*
+     * A uniform grid over the bounding box of the polygon, about
+     * one cell per triangle, where each cell lists the triangles
+     * whose bounding boxes overlap it, so locate only tests the
+     * triangles of one cell
+     */
+    Point origin;
+    Point corner;
+    double cell_size;
+    size_t columns;
+    size_t rows;
+
+    // the triangles of cell c are cell_triangles[cell_offsets[c]]...[cell_offsets[c + 1] - 1]
+    std::vector<uint32_t> cell_offsets;
+    std::vector<uint32_t> cell_triangles;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __TRIANGULATION_INDEX_HPP__
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef __VISIBILITY_SWEEP_HPP__
+#define __VISIBILITY_SWEEP_HPP__
+
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_grid.hpp"
+#include "polygon_geometry.hpp"
+
+namespace bfreeman {
+
+/*
+ * Lee's rotational plane sweep: finds the vertices visible from
+ * a vertex by sweeping a ray around it, keeping the polygon edges
+ * the ray crosses ordered by distance. A vertex is then visible
+ * if no edge in front of it blocks the ray, which makes a row of
+ * the adjacency list O(n log n) instead of O(n^2).
+ *
+ * Vertices that (nearly) line up with another vertex as seen from
+ * the swept vertex are tested directly through the EdgeGrid, so
+ * rows are identical to those of populate_vertex_vertex_adjacency.
+ */
+class VisibilitySweep {
+public:
+    /*
+     * edge_grid must be built over polygon and outlive the sweep
+     */
+    VisibilitySweep(const std::vector<std::vector<Point>>& polygon, const EdgeGrid& edge_grid);
+
+    /*
+     * Populates an adjacency list row with the chords between
+     * the vertex at idxp and every other vertex of the polygon
+     */
+    void populate_row(std::vector<Edge>& adj_list_row, const IndexPair idxp) const;
+
+private:
+    const std::vector<std::vector<Point>>& polygon;
+    const EdgeGrid& edge_grid;
+
+    // the vertices in node order, without start and end
+    std::vector<Point> points;
+    std::vector<IndexPair> idxps;
+
+    // position in points of the first vertex of each ring
+    std::vector<size_t> ring_offsets;
+
+    // edge k runs from vertex k to vertex next[k]; prev[k] is the vertex before k
+    std::vector<size_t> next;
+    std::vector<size_t> prev;
+
+    // the directions a chord can leave each vertex in
+    std::vector<VertexCone> cones;
+
+    double min_edge_length;
+};
+
+} // namespace bfreeman
+
+#endif // #ifndef __VISIBILITY_SWEEP_HPP__
\ No newline at end of file
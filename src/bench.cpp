@@ -0,0 +1,1452 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "edge_batch.hpp"
+#include "indexed_heap.hpp"
+#include "point_location.hpp"
+#include "polygon_geometry.hpp"
+#include "polygon_index.hpp"
+#include "query_stats.hpp"
+#include "route_stream.hpp"
+#include "test_data_reader.hpp"
+#include "triangulation_index.hpp"
+
+using Polygon = std::vector<std::vector<bfreeman::Point>>;
+using Query = std::pair<bfreeman::Point, bfreeman::Point>;
+using Clock = std::chrono::steady_clock;
+
+// every allocation made through operator new, to show which code allocates and how often
+std::atomic<size_t> allocations(0);
+
+// counts the allocation, rounding size up to a multiple of alignment as aligned_alloc requires
+void* counted_malloc(size_t size, const size_t alignment) {
+    allocations++;
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return malloc(size);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* operator new(size_t size) {
+    void* memory = counted_malloc(size, 0);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* memory = counted_malloc(size, (size_t) alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_malloc(size, (size_t) alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_malloc(size, (size_t) alignment);
+}
+
+/*
+ * Memory from malloc and aligned_alloc is released through free, out
+ * of line: GCC would otherwise see free called on a pointer from
+ * operator new wherever a delete is inlined, and warn of a mismatch
+ */
+__attribute__((noinline)) void release(void* memory) {
+    free(memory);
+}
+
+void operator delete(void* memory) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(memory);
+}
+
+double seconds_since(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+size_t vertex_count(const Polygon& polygon) {
+    size_t count = 0;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        count += polygon[i].size();
+    }
+    return count;
+}
+
+/*
+ * A rectangle split into a snaking corridor by walls that
+ * alternately hang from the top and stand on the bottom.
+ */
+Polygon comb_polygon(const size_t walls) {
+    const double spacing = 1.0, thickness = 0.2, height = 4.0, gap = 0.8;
+    double width = (walls + 1) * spacing;
+    Polygon polygon(1);
+
+    // along the bottom, left to right, up and down each standing wall
+    polygon[0].push_back({0, 0});
+    for (size_t k = 0; k < walls; k += 2) {
+        double x = (k + 1) * spacing;
+        polygon[0].push_back({x, 0});
+        polygon[0].push_back({x, height - gap});
+        polygon[0].push_back({x + thickness, height - gap});
+        polygon[0].push_back({x + thickness, 0});
+    }
+    polygon[0].push_back({width, 0});
+
+    // along the top, right to left, down and up each hanging wall
+    polygon[0].push_back({width, height});
+    for (size_t k = walls; k-- > 0;) {
+        if (k % 2 == 0) continue;
+        double x = (k + 1) * spacing;
+        polygon[0].push_back({x + thickness, height});
+        polygon[0].push_back({x + thickness, gap});
+        polygon[0].push_back({x, gap});
+        polygon[0].push_back({x, height});
+    }
+    polygon[0].push_back({0, height});
+    return polygon;
+}
+
+/*
+ * A star-shaped boundary with a jagged edge around
+ * a grid of small convex holes.
+ */
+Polygon star_polygon(const size_t boundary_vertices, const size_t holes, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    Polygon polygon(1);
+    for (size_t k = 0; k < boundary_vertices; k++) {
+        double angle = 2 * M_PI * k / boundary_vertices;
+        double radius = k % 2 ? 10 + 2 * unit(rng) : 8.5 + unit(rng);
+        polygon[0].push_back({radius * cos(angle), radius * sin(angle)});
+    }
+
+    // holes sit in the cells of a grid over the inner disc of radius 6
+    size_t side = (size_t) ceil(sqrt((double) holes)) + 1;
+    double cell = 12.0 / side;
+    for (size_t a = 0; a < side && polygon.size() <= holes; a++) {
+        for (size_t b = 0; b < side && polygon.size() <= holes; b++) {
+            double cx = -6 + cell * (a + 0.5), cy = -6 + cell * (b + 0.5);
+            if (cx * cx + cy * cy > 30) continue;
+            double radius = cell * 0.3 * (0.5 + unit(rng));
+            size_t corners = 3 + (size_t) (unit(rng) * 4);
+            std::vector<bfreeman::Point> hole;
+            for (size_t k = 0; k < corners; k++) {
+                double angle = 2 * M_PI * k / corners;
+                hole.push_back({cx + radius * cos(angle), cy + radius * sin(angle)});
+            }
+            polygon.push_back(hole);
+        }
+    }
+    return polygon;
+}
+
+/*
+ * A perfect maze carved depth first through a square of
+ * cells by cells. Its walls all connect to the outer wall,
+ * so the corridors form one polygon without holes.
+ */
+Polygon maze_polygon(const size_t cells, std::mt19937& rng) {
+    // unit blocks: cell (x, y) is block (2x + 1, 2y + 1), the blocks between are walls or passages
+    size_t side = 2 * cells + 1;
+    std::vector<bool> open(side * side, false);
+    auto block = [&](const size_t x, const size_t y) { return y * side + x; };
+
+    const int dx[4] = {1, 0, -1, 0};
+    const int dy[4] = {0, 1, 0, -1};
+    std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+    open[block(1, 1)] = true;
+    while (!stack.empty()) {
+        size_t x = stack.back().first, y = stack.back().second;
+        std::vector<int> directions;
+        for (int d = 0; d < 4; d++) {
+            long nx = (long) x + dx[d], ny = (long) y + dy[d];
+            if (nx < 0 || ny < 0 || nx >= (long) cells || ny >= (long) cells) continue;
+            if (!open[block(2 * nx + 1, 2 * ny + 1)]) directions.push_back(d);
+        }
+        if (directions.empty()) {
+            stack.pop_back();
+            continue;
+        }
+        int d = directions[rng() % directions.size()];
+        open[block(2 * x + 1 + dx[d], 2 * y + 1 + dy[d])] = true;
+        open[block(2 * (x + dx[d]) + 1, 2 * (y + dy[d]) + 1)] = true;
+        stack.emplace_back(x + dx[d], y + dy[d]);
+    }
+
+    // each side of an open block facing a wall is a boundary edge, open block on its left
+    size_t corners = side + 1;
+    std::vector<size_t> next_corner(corners * corners, SIZE_MAX);
+    auto is_open = [&](const long x, const long y) {
+        return x >= 0 && y >= 0 && x < (long) side && y < (long) side && open[block(x, y)];
+    };
+    for (size_t y = 0; y < side; y++) {
+        for (size_t x = 0; x < side; x++) {
+            if (!open[block(x, y)]) continue;
+            if (!is_open(x, (long) y - 1)) next_corner[y * corners + x] = y * corners + x + 1;
+            if (!is_open(x + 1, y)) next_corner[y * corners + x + 1] = (y + 1) * corners + x + 1;
+            if (!is_open(x, y + 1)) next_corner[(y + 1) * corners + x + 1] = (y + 1) * corners + x;
+            if (!is_open((long) x - 1, y)) next_corner[(y + 1) * corners + x] = y * corners + x;
+        }
+    }
+
+    // walk the boundary from the corner of the first cell, keeping the corners it turns at
+    std::vector<bfreeman::Point> ring;
+    size_t first = corners + 1, corner = first;
+    do {
+        ring.push_back({(double) (corner % corners), (double) (corner / corners)});
+        corner = next_corner[corner];
+    } while (corner != first);
+
+    Polygon polygon(1);
+    for (size_t k = 0; k < ring.size(); k++) {
+        const bfreeman::Point& prev = ring[(k + ring.size() - 1) % ring.size()];
+        const bfreeman::Point& next = ring[(k + 1) % ring.size()];
+        bool straight = (prev.x == ring[k].x && ring[k].x == next.x) || (prev.y == ring[k].y && ring[k].y == next.y);
+        if (!straight) polygon[0].push_back(ring[k]);
+    }
+    return polygon;
+}
+
+/*
+ * A square with a side by side grid of square holes.
+ */
+Polygon hole_grid_polygon(const size_t side) {
+    double width = 3.0 * side;
+    Polygon polygon = {{{0, 0}, {width, 0}, {width, width}, {0, width}}};
+    for (size_t a = 0; a < side; a++) {
+        for (size_t b = 0; b < side; b++) {
+            double x = 3.0 * a + 1, y = 3.0 * b + 1;
+            polygon.push_back({{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y + 1}});
+        }
+    }
+    return polygon;
+}
+
+bool inside_ring(const std::vector<bfreeman::Point>& ring, const bfreeman::Point& p) {
+    bool inside = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        if ((ring[i].y > p.y) != (ring[j].y > p.y) &&
+            p.x < (ring[j].x - ring[i].x) * (p.y - ring[i].y) / (ring[j].y - ring[i].y) + ring[i].x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool inside(const Polygon& polygon, const bfreeman::Point& p) {
+    if (!inside_ring(polygon[0], p)) return false;
+    for (size_t i = 1; i < polygon.size(); i++) {
+        if (inside_ring(polygon[i], p)) return false;
+    }
+    return true;
+}
+
+std::vector<Query> random_queries(const Polygon& polygon, const size_t count, std::mt19937& rng) {
+    bfreeman::Point min = polygon[0][0], max = polygon[0][0];
+    for (size_t j = 0; j < polygon[0].size(); j++) {
+        min = {fmin(min.x, polygon[0][j].x), fmin(min.y, polygon[0][j].y)};
+        max = {fmax(max.x, polygon[0][j].x), fmax(max.y, polygon[0][j].y)};
+    }
+    std::uniform_real_distribution<double> x(min.x, max.x), y(min.y, max.y);
+    auto random_point = [&]() {
+        bfreeman::Point p;
+        do {
+            p = {x(rng), y(rng)};
+        } while (!inside(polygon, p));
+        return p;
+    };
+
+    std::vector<Query> queries;
+    for (size_t k = 0; k < count; k++) {
+        bfreeman::Point start = random_point();
+        queries.emplace_back(start, random_point());
+    }
+    return queries;
+}
+
+void print_row(const std::string& label, const double value, const std::string& unit) {
+    std::cout << "  " << std::left << std::setw(28) << label << std::right << std::setw(12)
+              << std::fixed << std::setprecision(3) << value << " " << unit << std::endl;
+}
+
+// one column of a scaling table, or "-" if the phase was skipped
+void print_cell(const double value, const int width, const bool ran = true) {
+    std::cout << std::right << std::setw(width);
+    if (ran) {
+        std::cout << std::fixed << std::setprecision(value < 10 ? 4 : 1) << value;
+    } else {
+        std::cout << "-";
+    }
+}
+
+/*
+ * @return the value below which a fraction of the sorted values lie
+ */
+double percentile(const std::vector<double>& sorted, const double fraction) {
+    size_t idx = (size_t) (fraction * sorted.size());
+    return sorted[idx < sorted.size() ? idx : sorted.size() - 1];
+}
+
+struct ScalingOptions {
+    size_t max_vertices = 10000;
+    size_t queries = 200;
+
+    // a phase is not run at larger sizes once it takes longer than
+    // a tenth of this, since every phase grows at least quadratically
+    double seconds = 30;
+};
+
+/*
+ * Times, for polygons of 10 up to options.max_vertices vertices
+ * made by generate: a generate_adjacency_list call, building a
+ * PolygonIndex, and dijkstra_path queries against the index, one
+ * at a time (for their latency percentiles) and as a batch over
+ * every hardware thread.
+ */
+void bench_scaling(
+        const std::string& name,
+        const std::function<Polygon(size_t)>& generate,
+        const ScalingOptions& options,
+        std::mt19937& rng) {
+
+    std::cout << name << std::endl;
+    std::cout << std::right << std::setw(10) << "vertices" << std::setw(14) << "adj list s"
+              << std::setw(12) << "index s" << std::setw(12) << "edges" << std::setw(12) << "query/s"
+              << std::setw(12) << "batch q/s" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::endl;
+
+    bool run_adj_list = true, run_index = true;
+    const size_t sizes[] = {10, 30, 100, 300, 1000, 3000, 10000, 30000, 100000};
+    for (size_t size : sizes) {
+        if (size > options.max_vertices || !(run_adj_list || run_index)) break;
+
+        Polygon polygon = generate(size);
+        std::vector<Query> queries = random_queries(polygon, options.queries, rng);
+        std::cout << std::setw(10) << vertex_count(polygon);
+
+        double adj_list_seconds = 0;
+        if (run_adj_list) {
+            Clock::time_point start = Clock::now();
+            bfreeman::generate_adjacency_list(polygon, queries[0].first, queries[0].second);
+            adj_list_seconds = seconds_since(start);
+        }
+        print_cell(adj_list_seconds, 14, run_adj_list);
+        if (adj_list_seconds > options.seconds / 10) run_adj_list = false;
+
+        if (!run_index) {
+            std::cout << std::endl;
+            continue;
+        }
+
+        Clock::time_point start = Clock::now();
+        bfreeman::PolygonIndex index(polygon);
+        double index_seconds = seconds_since(start);
+        if (index_seconds > options.seconds / 10) run_index = false;
+
+        std::vector<double> latencies;
+        start = Clock::now();
+        for (size_t k = 0; k < queries.size(); k++) {
+            Clock::time_point query_start = Clock::now();
+            index.dijkstra_path(queries[k].first, queries[k].second);
+            latencies.push_back(1e6 * seconds_since(query_start));
+        }
+        double query_seconds = seconds_since(start);
+        std::sort(latencies.begin(), latencies.end());
+
+        start = Clock::now();
+        index.dijkstra_paths(queries, 0);
+        double batch_seconds = seconds_since(start);
+
+        print_cell(index_seconds, 12);
+        std::cout << std::setw(12) << index.get_graph().edge_count;
+        print_cell(queries.size() / query_seconds, 12);
+        print_cell(queries.size() / batch_seconds, 12);
+        print_cell(percentile(latencies, 0.5), 10);
+        print_cell(percentile(latencies, 0.9), 10);
+        print_cell(percentile(latencies, 0.99), 10);
+        print_cell(latencies.back(), 10);
+        std::cout << std::endl;
+    }
+}
+
+/*
+ * Compares Dijkstra's algorithm and A* over the same index.
+ */
+void bench_search(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, "
+              << queries.size() << " queries)" << std::endl;
+
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::QueryOptions dijkstra_options, a_star_options;
+    a_star_options.search = bfreeman::A_STAR;
+
+    double dijkstra_seconds = 0, a_star_seconds = 0;
+    size_t mismatches = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+        Clock::time_point start = Clock::now();
+        bfreeman::DijkstraData dijkstra = index.dijkstra_path(queries[k].first, queries[k].second, dijkstra_options);
+        dijkstra_seconds += seconds_since(start);
+
+        start = Clock::now();
+        bfreeman::DijkstraData a_star = index.dijkstra_path(queries[k].first, queries[k].second, a_star_options);
+        a_star_seconds += seconds_since(start);
+
+        if (fabs(dijkstra.distance - a_star.distance) > 10e-7) mismatches++;
+    }
+
+    print_row("dijkstra per query", 1e6 * dijkstra_seconds / queries.size(), "us");
+    print_row("a* per query", 1e6 * a_star_seconds / queries.size(), "us");
+    print_row("a* speedup", dijkstra_seconds / a_star_seconds, "x");
+    if (mismatches > 0) print_row("distance mismatches", (double) mismatches, "");
+}
+
+// tracks shortest known route from source to node idx
+struct PathDistance {
+    uint32_t idx;
+    double path_distance;
+};
+
+struct ComparePathDistance {
+    bool operator()(const PathDistance& d1, const PathDistance& d2) {
+        if (d1.path_distance != d2.path_distance) return d1.path_distance > d2.path_distance;
+        return d1.idx > d2.idx;
+    }
+};
+
+/*
+ * The search PolygonIndex ran before IndexedHeap: every node is
+ * queued up front, a shorter path found to a node queues it again,
+ * and the path is built by inserting at its front.
+ *
+ * @return the number of heap pushes
+ */
+size_t lazy_search(const bfreeman::CompactGraphView& graph, const uint32_t source, const uint32_t target,
+                   std::vector<uint32_t>& path) {
+    size_t node_count = graph.node_count, pushes = 0;
+    std::priority_queue<PathDistance, std::vector<PathDistance>, ComparePathDistance> queue;
+    std::vector<double> distances(node_count, __DBL_MAX__);
+    std::vector<bool> visited(node_count);
+    std::vector<uint32_t> prev(node_count, source);
+
+    distances[source] = 0;
+    for (uint32_t idx = 0; idx < node_count; idx++, pushes++) {
+        queue.push((PathDistance) {idx, distances[idx]});
+    }
+    while (!queue.empty()) {
+        uint32_t idx = queue.top().idx;
+        queue.pop();
+        visited[idx] = true;
+        if (idx == target) break;
+        for (size_t k = graph.offsets[idx]; k < graph.offsets[idx + 1]; k++) {
+            uint32_t adj_idx = graph.targets[k];
+            if (visited[adj_idx] || distances[adj_idx] <= distances[idx] + graph.weights[k]) continue;
+            distances[adj_idx] = distances[idx] + graph.weights[k];
+            prev[adj_idx] = idx;
+            queue.push((PathDistance) {adj_idx, distances[adj_idx]});
+            pushes++;
+        }
+    }
+
+    path.clear();
+    for (uint32_t idx = target; idx != source; idx = prev[idx]) path.insert(path.begin(), idx);
+    path.insert(path.begin(), source);
+    return pushes;
+}
+
+/*
+ * The search PolygonIndex runs now: nodes are queued once reached,
+ * with their keys lowered in place, and the path is built back to
+ * front and then reversed. The heap and arrays are reused across
+ * searches.
+ *
+ * @return the number of heap pushes and key decreases
+ */
+size_t indexed_search(const bfreeman::CompactGraphView& graph, const uint32_t source, const uint32_t target,
+                      bfreeman::IndexedHeap& queue, std::vector<double>& distances, std::vector<uint32_t>& prev,
+                      std::vector<uint32_t>& path) {
+    size_t node_count = graph.node_count, pushes = 1;
+    queue.reset(node_count);
+    distances.assign(node_count, __DBL_MAX__);
+    prev.resize(node_count);
+
+    distances[source] = 0;
+    queue.push_or_decrease(source, 0);
+    while (!queue.empty()) {
+        uint32_t idx = queue.pop();
+        if (idx == target) break;
+        for (size_t k = graph.offsets[idx]; k < graph.offsets[idx + 1]; k++) {
+            uint32_t adj_idx = graph.targets[k];
+            if (queue.is_settled(adj_idx) || distances[adj_idx] <= distances[idx] + graph.weights[k]) continue;
+            distances[adj_idx] = distances[idx] + graph.weights[k];
+            prev[adj_idx] = idx;
+            queue.push_or_decrease(adj_idx, distances[adj_idx]);
+            pushes++;
+        }
+    }
+
+    path.clear();
+    for (uint32_t idx = target; idx != source; idx = prev[idx]) path.push_back(idx);
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+    return pushes;
+}
+
+/*
+ * Compares lazy_search and indexed_search between random pairs of
+ * vertices of the graph of polygon, then counts the allocations of
+ * a whole PolygonIndex query.
+ */
+void bench_heap(const std::string& name, const Polygon& polygon, const size_t searches, std::mt19937& rng) {
+    bfreeman::PolygonIndex index(polygon);
+    const bfreeman::CompactGraphView& graph = index.get_graph();
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << graph.edge_count
+              << " edges, " << searches << " searches)" << std::endl;
+
+    std::uniform_int_distribution<uint32_t> vertex(2, (uint32_t) index.get_node_count() - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (size_t k = 0; k < searches; k++) pairs.emplace_back(vertex(rng), vertex(rng));
+
+    std::vector<uint32_t> lazy_path, indexed_path;
+    size_t lazy_pushes = 0, lazy_allocations = allocations;
+    Clock::time_point start = Clock::now();
+    for (size_t k = 0; k < pairs.size(); k++) {
+        lazy_pushes += lazy_search(graph, pairs[k].first, pairs[k].second, lazy_path);
+    }
+    double lazy_seconds = seconds_since(start);
+    lazy_allocations = allocations - lazy_allocations;
+
+    bfreeman::IndexedHeap queue;
+    std::vector<double> distances;
+    std::vector<uint32_t> prev;
+    size_t indexed_pushes = 0, indexed_allocations = allocations, mismatches = 0;
+    start = Clock::now();
+    for (size_t k = 0; k < pairs.size(); k++) {
+        indexed_pushes += indexed_search(graph, pairs[k].first, pairs[k].second, queue, distances, prev, indexed_path);
+    }
+    double indexed_seconds = seconds_since(start);
+    indexed_allocations = allocations - indexed_allocations;
+
+    for (size_t k = 0; k < pairs.size(); k++) {
+        lazy_search(graph, pairs[k].first, pairs[k].second, lazy_path);
+        indexed_search(graph, pairs[k].first, pairs[k].second, queue, distances, prev, indexed_path);
+        if (lazy_path != indexed_path) mismatches++;
+    }
+
+    double per_search = 1.0 / searches;
+    print_row("lazy heap per search", 1e6 * per_search * lazy_seconds, "us");
+    print_row("  pushes", per_search * lazy_pushes, "");
+    print_row("  allocations", per_search * lazy_allocations, "");
+    print_row("indexed heap per search", 1e6 * per_search * indexed_seconds, "us");
+    print_row("  pushes and decreases", per_search * indexed_pushes, "");
+    print_row("  allocations", per_search * indexed_allocations, "");
+    print_row("  speedup", lazy_seconds / indexed_seconds, "x");
+    if (mismatches > 0) print_row("path mismatches", (double) mismatches, "");
+
+    std::vector<Query> queries = random_queries(polygon, searches, rng);
+    size_t query_allocations = allocations;
+    for (size_t k = 0; k < queries.size(); k++) index.dijkstra_path(queries[k].first, queries[k].second);
+    print_row("allocations per query", per_search * (allocations - query_allocations), "");
+}
+
+/*
+ * Prints the QueryStats of building an index over polygon and of
+ * running queries against it with each search, per query. Only
+ * counted when built with DIJKSTRA_POLYGON_STATS.
+ */
+void bench_stats(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, "
+              << queries.size() << " queries)" << std::endl;
+
+    bfreeman::QueryStats build_stats;
+    bfreeman::IndexOptions index_options;
+    index_options.stats = &build_stats;
+    bfreeman::PolygonIndex index(polygon, index_options);
+    print_row("index check_intersect", (double) build_stats.check_intersect_calls, "");
+    print_row("index chords accepted", (double) build_stats.chords_accepted, "");
+    print_row("index chords rejected", (double) build_stats.chords_rejected, "");
+    print_row("index build", 1e3 * build_stats.build_seconds, "ms");
+
+    const bfreeman::SearchAlgorithm searches[] = {bfreeman::DIJKSTRA, bfreeman::A_STAR};
+    const std::string search_names[] = {"dijkstra", "a*"};
+    for (size_t s = 0; s < 2; s++) {
+        bfreeman::QueryStats stats;
+        bfreeman::QueryOptions options;
+        options.search = searches[s];
+        options.stats = &stats;
+        for (size_t k = 0; k < queries.size(); k++) {
+            index.dijkstra_path(queries[k].first, queries[k].second, options);
+        }
+
+        double per_query = 1.0 / queries.size();
+        std::cout << "  " << search_names[s] << std::endl;
+        print_row("  check_intersect", per_query * stats.check_intersect_calls, "");
+        print_row("  chords accepted", per_query * stats.chords_accepted, "");
+        print_row("  chords rejected", per_query * stats.chords_rejected, "");
+        print_row("  heap pushes", per_query * stats.heap_pushes, "");
+        print_row("  heap pops", per_query * stats.heap_pops, "");
+        print_row("  nodes settled", per_query * stats.nodes_settled, "");
+        print_row("  connect", 1e6 * per_query * stats.build_seconds, "us");
+        print_row("  search", 1e6 * per_query * stats.search_seconds, "us");
+        print_row("  reconstruction", 1e6 * per_query * stats.reconstruction_seconds, "us");
+    }
+}
+
+/*
+ * Times paths from one start point to many end points, as separate
+ * dijkstra_path calls and read off one ShortestPathTree
+ */
+void bench_tree(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, "
+              << queries.size() << " end points)" << std::endl;
+
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::Point start = queries[0].first;
+
+    Clock::time_point clock_start = Clock::now();
+    std::vector<bfreeman::DijkstraData> separate;
+    for (size_t k = 0; k < queries.size(); k++) {
+        separate.push_back(index.dijkstra_path(start, queries[k].second));
+    }
+    double separate_seconds = seconds_since(clock_start);
+
+    clock_start = Clock::now();
+    bfreeman::ShortestPathTree tree = index.shortest_path_tree(start);
+    double tree_seconds = seconds_since(clock_start);
+    size_t mismatches = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+        if (index.tree_path(tree, queries[k].second).distance != separate[k].distance) mismatches++;
+    }
+    double tree_query_seconds = seconds_since(clock_start) - tree_seconds;
+
+    print_row("dijkstra_path per end", 1e6 * separate_seconds / queries.size(), "us");
+    print_row("tree build", 1e6 * tree_seconds, "us");
+    print_row("tree per end", 1e6 * tree_query_seconds / queries.size(), "us");
+    print_row("speedup", separate_seconds / (tree_seconds + tree_query_seconds), "x");
+    if (mismatches > 0) print_row("distance mismatches", (double) mismatches, "");
+}
+
+/*
+ * Times, for polygons of 10 up to options.max_vertices vertices
+ * made by generate: building a TriangulationIndex and its
+ * queries. While a PolygonIndex can still be built within the
+ * time budget, the paths are also compared to its shortest
+ * paths, as the mean and worst ratio of their lengths.
+ */
+void bench_triangulation(
+        const std::string& name,
+        const std::function<Polygon(size_t)>& generate,
+        const ScalingOptions& options,
+        std::mt19937& rng) {
+
+    std::cout << name << std::endl;
+    std::cout << std::right << std::setw(10) << "vertices" << std::setw(12) << "index s"
+              << std::setw(12) << "triangles" << std::setw(12) << "query/s" << std::setw(12) << "batch q/s"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(12) << "mean ratio"
+              << std::setw(12) << "max ratio" << std::endl;
+
+    bool run_compare = true;
+    const size_t sizes[] = {10, 30, 100, 300, 1000, 3000, 10000, 30000, 100000, 300000};
+    for (size_t size : sizes) {
+        if (size > options.max_vertices) break;
+
+        Polygon polygon = generate(size);
+        std::vector<Query> queries = random_queries(polygon, options.queries, rng);
+        std::cout << std::setw(10) << vertex_count(polygon);
+
+        Clock::time_point start = Clock::now();
+        bfreeman::TriangulationIndex index(polygon);
+        double index_seconds = seconds_since(start);
+        if (index_seconds > options.seconds / 10) {
+            print_cell(index_seconds, 12);
+            std::cout << std::endl;
+            break;
+        }
+
+        std::vector<double> latencies;
+        std::vector<bfreeman::DijkstraData> paths;
+        start = Clock::now();
+        for (size_t k = 0; k < queries.size(); k++) {
+            Clock::time_point query_start = Clock::now();
+            paths.push_back(index.dijkstra_path(queries[k].first, queries[k].second));
+            latencies.push_back(1e6 * seconds_since(query_start));
+        }
+        double query_seconds = seconds_since(start);
+        std::sort(latencies.begin(), latencies.end());
+
+        start = Clock::now();
+        index.dijkstra_paths(queries, 0);
+        double batch_seconds = seconds_since(start);
+
+        double mean_ratio = 0, max_ratio = 0;
+        if (run_compare) {
+            start = Clock::now();
+            bfreeman::PolygonIndex exact(polygon);
+            if (seconds_since(start) > options.seconds / 10) run_compare = false;
+            for (size_t k = 0; k < queries.size(); k++) {
+                double ratio = paths[k].distance / exact.dijkstra_path(queries[k].first, queries[k].second).distance;
+                mean_ratio += ratio / queries.size();
+                max_ratio = std::max(max_ratio, ratio);
+            }
+        }
+
+        print_cell(index_seconds, 12);
+        std::cout << std::setw(12) << index.get_triangles().size();
+        print_cell(queries.size() / query_seconds, 12);
+        print_cell(queries.size() / batch_seconds, 12);
+        print_cell(percentile(latencies, 0.5), 10);
+        print_cell(percentile(latencies, 0.99), 10);
+        print_cell(mean_ratio, 12, max_ratio > 0);
+        print_cell(max_ratio, 12, max_ratio > 0);
+        std::cout << std::endl;
+    }
+}
+
+/*
+ * Compares building an index to saving it once and mapping the
+ * file back in, with and without checking its checksum, and
+ * times the first query against the mapped index (which pages
+ * in the parts of the file it reads)
+ */
+void bench_index_file(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices)" << std::endl;
+    std::string path = (std::filesystem::temp_directory_path() / "bench.index").string();
+
+    Clock::time_point start = Clock::now();
+    bfreeman::PolygonIndex index(polygon);
+    double build_seconds = seconds_since(start);
+
+    start = Clock::now();
+    index.save(path);
+    double save_seconds = seconds_since(start);
+
+    double load_seconds[2], first_query_seconds = 0;
+    size_t load_allocations = 0;
+    for (int verify = 1; verify >= 0; verify--) {
+        std::unique_ptr<bfreeman::PolygonIndex> loaded;
+        size_t allocations_before = allocations.load();
+        start = Clock::now();
+        bfreeman::PolygonIndex::load(path, loaded, verify == 1);
+        load_seconds[verify] = seconds_since(start);
+        load_allocations = allocations.load() - allocations_before;
+
+        if (verify == 0) {
+            start = Clock::now();
+            loaded->dijkstra_path(queries[0].first, queries[0].second);
+            first_query_seconds = seconds_since(start);
+        }
+    }
+
+    print_row("build", 1e3 * build_seconds, "ms");
+    print_row("save", 1e3 * save_seconds, "ms");
+    print_row("file size", std::filesystem::file_size(path) / (double) (1 << 20), "MB");
+    print_row("load, checksum verified", 1e3 * load_seconds[1], "ms");
+    print_row("load, not verified", 1e3 * load_seconds[0], "ms");
+    print_row("allocations per load", (double) load_allocations, "");
+    print_row("first query after load", 1e6 * first_query_seconds, "us");
+    std::filesystem::remove(path);
+}
+
+/*
+ * Compares building an index again to updating it in place: one
+ * small triangular hole inserted and removed again at each of the
+ * query start points, and one vertex per query nudged towards its
+ * next vertex and moved back
+ */
+void bench_updates(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices)" << std::endl;
+
+    Clock::time_point start = Clock::now();
+    bfreeman::PolygonIndex index(polygon);
+    double build_seconds = seconds_since(start);
+
+    double insert_seconds = 0, remove_seconds = 0, move_seconds = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+        bfreeman::Point point = queries[k].first;
+        start = Clock::now();
+        index.insert_hole({point, {point.x + 0.01, point.y}, {point.x, point.y + 0.01}});
+        insert_seconds += seconds_since(start);
+
+        start = Clock::now();
+        index.remove_hole(index.get_polygon().size() - 1);
+        remove_seconds += seconds_since(start);
+
+        const std::vector<bfreeman::Point>& boundary = index.get_polygon()[0];
+        size_t j = k * 7919 % boundary.size();
+        bfreeman::Point vertex = boundary[j], next = boundary[(j + 1) % boundary.size()];
+        start = Clock::now();
+        index.move_vertex(bfreeman::IndexPair(0, j), {(3 * vertex.x + next.x) / 4, (3 * vertex.y + next.y) / 4});
+        index.move_vertex(bfreeman::IndexPair(0, j), vertex);
+        move_seconds += seconds_since(start) / 2;
+    }
+
+    print_row("build", 1e3 * build_seconds, "ms");
+    print_row("insert hole", 1e3 * insert_seconds / queries.size(), "ms");
+    print_row("remove hole", 1e3 * remove_seconds / queries.size(), "ms");
+    print_row("move vertex", 1e3 * move_seconds / queries.size(), "ms");
+}
+
+/*
+ * Times the same queries without and with a few square obstacles
+ * at random points of the polygon, and counts how many paths the
+ * obstacles moved or cut off
+ */
+void bench_obstacles(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries,
+                     std::mt19937& rng) {
+    bfreeman::PolygonIndex index(polygon);
+    std::vector<Query> centers = random_queries(polygon, 5, rng);
+    Polygon squares;
+    for (size_t k = 0; k < centers.size(); k++) {
+        bfreeman::Point center = centers[k].first;
+        squares.push_back({{center.x - 0.5, center.y - 0.5}, {center.x + 0.5, center.y - 0.5},
+                           {center.x + 0.5, center.y + 0.5}, {center.x - 0.5, center.y + 0.5}});
+    }
+    bfreeman::ObstacleSet obstacles(squares);
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << squares.size() << " obstacles)"
+              << std::endl;
+
+    bfreeman::QueryOptions obstacle_options;
+    obstacle_options.obstacles = &obstacles;
+    double plain_seconds = 0, obstacle_seconds = 0;
+    size_t moved = 0, cut_off = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+        Clock::time_point start = Clock::now();
+        bfreeman::DijkstraData plain = index.dijkstra_path(queries[k].first, queries[k].second);
+        plain_seconds += seconds_since(start);
+
+        start = Clock::now();
+        bfreeman::DijkstraData avoiding = index.dijkstra_path(queries[k].first, queries[k].second, obstacle_options);
+        obstacle_seconds += seconds_since(start);
+
+        if (avoiding.distance == __DBL_MAX__) {
+            cut_off++;
+        } else if (avoiding.distance != plain.distance) {
+            moved++;
+        }
+    }
+
+    print_row("query", 1e6 * plain_seconds / queries.size(), "us");
+    print_row("query with obstacles", 1e6 * obstacle_seconds / queries.size(), "us");
+    print_row("paths moved", (double) moved, "");
+    print_row("paths cut off", (double) cut_off, "");
+}
+
+/*
+ * Times the same queries allocating afresh and reusing one
+ * QueryContext, on a PolygonIndex and a TriangulationIndex, and
+ * counts the allocations of each once the context has been used
+ */
+void bench_context(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::TriangulationIndex triangulation(polygon);
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << queries.size() << " queries)"
+              << std::endl;
+
+    bfreeman::QueryContext context;
+    for (size_t k = 0; k < queries.size(); k++) {
+        index.dijkstra_path(queries[k].first, queries[k].second, context);
+        triangulation.dijkstra_path(queries[k].first, queries[k].second, context);
+    }
+
+    double fresh_seconds[2] = {0, 0}, context_seconds[2] = {0, 0};
+    size_t fresh_allocations[2] = {0, 0}, context_allocations[2] = {0, 0};
+    size_t mismatches = 0;
+    for (size_t k = 0; k < queries.size(); k++) {
+        size_t before = allocations;
+        Clock::time_point start = Clock::now();
+        bfreeman::DijkstraData fresh = index.dijkstra_path(queries[k].first, queries[k].second);
+        fresh_seconds[0] += seconds_since(start);
+        fresh_allocations[0] += allocations - before;
+
+        before = allocations;
+        start = Clock::now();
+        const bfreeman::DijkstraData& reused = index.dijkstra_path(queries[k].first, queries[k].second, context);
+        context_seconds[0] += seconds_since(start);
+        context_allocations[0] += allocations - before;
+        if (reused.distance != fresh.distance || reused.path != fresh.path) mismatches++;
+
+        before = allocations;
+        start = Clock::now();
+        fresh = triangulation.dijkstra_path(queries[k].first, queries[k].second);
+        fresh_seconds[1] += seconds_since(start);
+        fresh_allocations[1] += allocations - before;
+
+        before = allocations;
+        start = Clock::now();
+        triangulation.dijkstra_path(queries[k].first, queries[k].second, context);
+        context_seconds[1] += seconds_since(start);
+        context_allocations[1] += allocations - before;
+        if (context.result.distance != fresh.distance || context.result.path != fresh.path) mismatches++;
+    }
+
+    const std::string index_names[] = {"polygon index", "triangulation"};
+    double per_query = 1.0 / queries.size();
+    for (size_t i = 0; i < 2; i++) {
+        print_row(index_names[i] + " query", 1e6 * per_query * fresh_seconds[i], "us");
+        print_row("  allocations", per_query * fresh_allocations[i], "");
+        print_row("  with a context", 1e6 * per_query * context_seconds[i], "us");
+        print_row("  allocations", per_query * context_allocations[i], "");
+    }
+    if (mismatches > 0) print_row("path mismatches", (double) mismatches, "");
+}
+
+/*
+ * Times answering the same queries as a dijkstra_paths batch and
+ * through route_stream as text and as binary (from and to files),
+ * to show what reading, parsing and writing add to the searches
+ */
+void bench_stream(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    bfreeman::PolygonIndex index(polygon);
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << queries.size() << " queries)"
+              << std::endl;
+
+    Clock::time_point start = Clock::now();
+    index.dijkstra_paths(queries);
+    print_row("batch per query", 1e6 * seconds_since(start) / queries.size(), "us");
+
+    std::string text, binary;
+    char buffer[32];
+    for (size_t k = 0; k < queries.size(); k++) {
+        double values[4] = {queries[k].first.x, queries[k].first.y, queries[k].second.x, queries[k].second.y};
+        for (size_t v = 0; v < 4; v++) {
+            text.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), values[v]).ptr);
+            text.push_back(v < 3 ? ' ' : '\n');
+        }
+        binary.append((const char*) values, sizeof(values));
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string queries_path = (directory / "bench_stream.queries").string();
+    std::string answers_path = (directory / "bench_stream.answers").string();
+    const bfreeman::StreamFormat formats[] = {bfreeman::TEXT_STREAM, bfreeman::BINARY_STREAM};
+    const std::string format_names[] = {"text stream per query", "binary stream per query"};
+    for (size_t f = 0; f < 2; f++) {
+        const std::string& input = formats[f] == bfreeman::TEXT_STREAM ? text : binary;
+        std::ofstream(queries_path, std::ios::binary).write(input.data(), input.size());
+        int in_fd = open(queries_path.c_str(), O_RDONLY);
+        int out_fd = open(answers_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bfreeman::StreamOptions options;
+        options.format = formats[f];
+
+        start = Clock::now();
+        bfreeman::StreamStatus status = bfreeman::route_stream(index, in_fd, out_fd, options);
+        print_row(format_names[f], 1e6 * seconds_since(start) / queries.size(), "us");
+        if (status != bfreeman::STREAM_OK) print_row("  stream status", (double) status, "");
+        print_row("  answer bytes", (double) std::filesystem::file_size(answers_path) / queries.size(), "");
+        close(in_fd);
+        close(out_fd);
+    }
+    std::filesystem::remove(queries_path);
+    std::filesystem::remove(answers_path);
+}
+
+/*
+ * Writes a test file of polygon with edges_per_row made-up edges
+ * per adjacency list row (a few MB, as a real map's regression test
+ * would be) and times reading it with load_test_data and, when run
+ * from the project directory, with read_test_data
+ */
+void bench_fixture(const std::string& name, const Polygon& polygon, const size_t edges_per_row,
+                   std::mt19937& rng) {
+    size_t rows = vertex_count(polygon) + 2;
+    bool from_project = std::filesystem::is_directory("tests");
+    std::string file_name = "bench_fixture";
+    std::string path = from_project ? test_data_path(file_name)
+                                    : (std::filesystem::temp_directory_path() / file_name).string();
+    {
+        std::ofstream file(path);
+        file << std::setprecision(17) << "#SHAPE\n";
+        for (size_t i = 0; i < polygon.size(); i++) {
+            for (const bfreeman::Point& point : polygon[i]) file << i << ", " << point.x << ", " << point.y << "\n";
+        }
+        file << "#START_END\n" << polygon[0][0].x << ", " << polygon[0][0].y << ", "
+             << polygon[0][1].x << ", " << polygon[0][1].y << "\n#ADJACENCY_LIST\n";
+        std::uniform_int_distribution<size_t> ring(0, polygon.size() - 1), vertex(0, 99);
+        std::uniform_real_distribution<double> distance(0, 100);
+        for (size_t row = 0; row < rows; row++) {
+            for (size_t k = 0; k < edges_per_row; k++) {
+                file << row << ", " << ring(rng) << ", " << vertex(rng) << ", " << (k % 2 ? "true" : "false") << ", "
+                     << distance(rng) << "\n";
+            }
+        }
+        file << "#PATH_LENGTH\n" << distance(rng) << "\n#PATH_POINTS\n"
+             << polygon[0][0].x << ", " << polygon[0][0].y << "\n" << polygon[0][1].x << ", " << polygon[0][1].y;
+    }
+    double megabytes = std::filesystem::file_size(path) / 1e6;
+    std::cout << name << " (" << megabytes << " MB, " << rows * edges_per_row << " edges)" << std::endl;
+
+    Clock::time_point start = Clock::now();
+    TestData data;
+    TestDataStatus status = load_test_data(path, data);
+    double load_seconds = seconds_since(start);
+    print_row("load_test_data", 1e3 * load_seconds, "ms");
+    print_row("  throughput", megabytes / load_seconds, "MB/s");
+    if (status != TEST_DATA_OK) print_row("  status", (double) status, "");
+
+    if (from_project) {
+        start = Clock::now();
+        delete (Polygon*) read_test_data(SHAPE, file_name, polygon.size());
+        delete (PointPair*) read_test_data(START_END, file_name, 0);
+        delete (AdjacencyList*) read_test_data(ADJACENCY_LIST, file_name, rows);
+        delete (double*) read_test_data(PATH_LENGTH, file_name, 0);
+        delete (std::vector<bfreeman::Point>*) read_test_data(PATH_POINTS, file_name, 0);
+        double read_seconds = seconds_since(start);
+        print_row("read_test_data, all sections", 1e3 * read_seconds, "ms");
+        print_row("  speedup", read_seconds / load_seconds, "x");
+    }
+    std::filesystem::remove(path);
+}
+
+/*
+ * Converts polygon and queries to coordinates of type T, scaled
+ * by scale and rounded if T is an integer
+ */
+template<typename T>
+std::pair<std::vector<std::vector<bfreeman::BasicPoint<T>>>, std::vector<std::pair<bfreeman::BasicPoint<T>,
+        bfreeman::BasicPoint<T>>>> convert(const Polygon& polygon, const std::vector<Query>& queries, double scale) {
+    auto point = [&](const bfreeman::Point& p) {
+        if (std::is_integral<T>::value) return (bfreeman::BasicPoint<T>) {(T) std::lround(p.x * scale),
+                                                                          (T) std::lround(p.y * scale)};
+        return (bfreeman::BasicPoint<T>) {(T) (p.x * scale), (T) (p.y * scale)};
+    };
+    std::vector<std::vector<bfreeman::BasicPoint<T>>> converted(polygon.size());
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (const bfreeman::Point& p : polygon[i]) converted[i].push_back(point(p));
+    }
+    std::vector<std::pair<bfreeman::BasicPoint<T>, bfreeman::BasicPoint<T>>> converted_queries;
+    for (const Query& query : queries) converted_queries.emplace_back(point(query.first), point(query.second));
+    return {converted, converted_queries};
+}
+
+/*
+ * Times the templated dijkstra_path (building the adjacency list
+ * and searching it) with double, float and int32_t millimetre
+ * coordinates, and how far the float and int32_t path lengths
+ * are from the double ones
+ */
+void bench_scalars(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << queries.size() << " queries)"
+              << std::endl;
+    const double millimetres = 1000;
+    auto doubles = convert<double>(polygon, queries, 1);
+    auto floats = convert<float>(polygon, queries, 1);
+    auto ints = convert<int32_t>(polygon, queries, millimetres);
+
+    std::vector<double> double_distances;
+    double seconds[3] = {0, 0, 0}, worst_error[3] = {0, 0, 0};
+    for (size_t k = 0; k < queries.size(); k++) {
+        Clock::time_point start = Clock::now();
+        // the explicit template argument picks the adjacency list search over the PolygonIndex overload
+        double distance = bfreeman::dijkstra_path<double>(doubles.first, doubles.second[k].first,
+                                                          doubles.second[k].second).distance;
+        seconds[0] += seconds_since(start);
+
+        start = Clock::now();
+        double float_distance = bfreeman::dijkstra_path(floats.first, floats.second[k].first,
+                                                        floats.second[k].second).distance;
+        seconds[1] += seconds_since(start);
+
+        start = Clock::now();
+        double int_distance = bfreeman::dijkstra_path(ints.first, ints.second[k].first,
+                                                      ints.second[k].second).distance / millimetres;
+        seconds[2] += seconds_since(start);
+
+        worst_error[1] = std::max(worst_error[1], fabs(float_distance - distance) / distance);
+        worst_error[2] = std::max(worst_error[2], fabs(int_distance - distance) / distance);
+    }
+
+    const std::string labels[] = {"double query", "float query", "int32_t query"};
+    const size_t point_bytes[] = {sizeof(bfreeman::BasicPoint<double>), sizeof(bfreeman::BasicPoint<float>),
+                                  sizeof(bfreeman::BasicPoint<int32_t>)};
+    for (size_t t = 0; t < 3; t++) {
+        print_row(labels[t], 1e6 * seconds[t] / queries.size(), "us");
+        print_row("  bytes per point", (double) point_bytes[t], "");
+        if (t > 0) print_row("  worst length error", 1e6 * worst_error[t], "ppm");
+    }
+}
+
+/*
+ * Times locating random points around a polygon with a
+ * PointLocator against the even-odd test over every edge, and
+ * the same queries with and without their endpoints checked
+ */
+void bench_locate(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries,
+                  const size_t points, std::mt19937& rng) {
+    std::cout << name << " (" << vertex_count(polygon) << " vertices, " << points << " points, " << queries.size()
+              << " queries)" << std::endl;
+
+    Clock::time_point start = Clock::now();
+    bfreeman::PointLocator locator(polygon);
+    double build_seconds = seconds_since(start);
+
+    // points over a box a little larger than the polygon, so some land outside and in holes
+    bfreeman::Point min = polygon[0][0], max = polygon[0][0];
+    for (const bfreeman::Point& vertex : polygon[0]) {
+        min = {fmin(min.x, vertex.x), fmin(min.y, vertex.y)};
+        max = {fmax(max.x, vertex.x), fmax(max.y, vertex.y)};
+    }
+    double margin = 0.1 * fmax(max.x - min.x, max.y - min.y);
+    std::uniform_real_distribution<double> x(min.x - margin, max.x + margin), y(min.y - margin, max.y + margin);
+    std::vector<bfreeman::Point> samples(points);
+    for (bfreeman::Point& sample : samples) sample = {x(rng), y(rng)};
+
+    size_t brute_inside = 0, located_inside = 0;
+    start = Clock::now();
+    for (const bfreeman::Point& sample : samples) brute_inside += inside(polygon, sample);
+    double brute_seconds = seconds_since(start);
+    start = Clock::now();
+    for (const bfreeman::Point& sample : samples) {
+        located_inside += locator.locate(sample).point_class == bfreeman::POINT_INSIDE;
+    }
+    double locate_seconds = seconds_since(start);
+
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::QueryContext context;
+    bfreeman::QueryOptions reject_options;
+    reject_options.endpoints = bfreeman::REJECT_ENDPOINTS;
+    double seconds[2] = {0, 0};
+    for (size_t k = 0; k < queries.size(); k++) {
+        start = Clock::now();
+        index.dijkstra_path(queries[k].first, queries[k].second, context);
+        seconds[0] += seconds_since(start);
+
+        start = Clock::now();
+        index.dijkstra_path(queries[k].first, queries[k].second, context, reject_options);
+        seconds[1] += seconds_since(start);
+    }
+
+    print_row("build", 1e3 * build_seconds, "ms");
+    print_row("even-odd over every edge", 1e9 * brute_seconds / points, "ns");
+    print_row("PointLocator::locate", 1e9 * locate_seconds / points, "ns");
+    print_row("points inside (even-odd)", (double) brute_inside, "");
+    print_row("points inside (locate)", (double) located_inside, "");
+    print_row("query", 1e6 * seconds[0] / queries.size(), "us");
+    print_row("query, endpoints rejected", 1e6 * seconds[1] / queries.size(), "us");
+}
+
+/*
+ * Times finding the nearest of a growing number of goals with
+ * one dijkstra_path per goal against one nearest_goal search,
+ * and counts the answers that differ in length
+ */
+void bench_goals(const std::string& name, const Polygon& polygon, const std::vector<Query>& queries) {
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::QueryContext context;
+    std::cout << name << " (" << vertex_count(polygon) << " vertices)" << std::endl;
+
+    // the goals of each count are the end points of the first queries after the start's
+    const size_t goal_counts[] = {1, 4, 16, 64};
+    const size_t starts = 10;
+    for (size_t goal_count : goal_counts) {
+        double seconds[2] = {0, 0};
+        size_t differ = 0;
+        for (size_t s = 0; s < starts; s++) {
+            bfreeman::Point start = queries[s].first;
+            std::vector<bfreeman::Point> goals;
+            for (size_t g = 0; g < goal_count; g++) goals.push_back(queries[(s + 1 + g) % queries.size()].second);
+
+            Clock::time_point clock_start = Clock::now();
+            double nearest = __DBL_MAX__;
+            for (size_t g = 0; g < goals.size(); g++) {
+                nearest = std::min(nearest, index.dijkstra_path(start, goals[g], context).distance);
+            }
+            seconds[0] += seconds_since(clock_start);
+
+            clock_start = Clock::now();
+            index.nearest_goal(start, goals, context);
+            seconds[1] += seconds_since(clock_start);
+            if (fabs(context.result.distance - nearest) > 1e-9) differ++;
+        }
+        std::string goals_label = std::to_string(goal_count) + " goals";
+        print_row(goals_label + ", a query per goal", 1e6 * seconds[0] / starts, "us");
+        print_row(goals_label + ", nearest_goal", 1e6 * seconds[1] / starts, "us");
+        print_row(goals_label + ", lengths differing", (double) differ, "");
+    }
+}
+
+/*
+ * Compares an index with an all-pairs table to one without over
+ * polygons of growing size: the extra build time and memory, and
+ * the query times of Dijkstra, A* and a TABLE_LOOKUP
+ */
+void bench_table(const std::string& name, const std::function<Polygon(size_t)>& generate,
+                 const size_t max_vertices, const size_t query_count, std::mt19937& rng) {
+    std::cout << name << std::endl;
+    std::cout << std::right << std::setw(10) << "vertices" << std::setw(12) << "index s" << std::setw(12)
+              << "table s" << std::setw(12) << "table MB" << std::setw(14) << "dijkstra us" << std::setw(10)
+              << "a* us" << std::setw(10) << "table us" << std::endl;
+
+    const size_t sizes[] = {100, 300, 1000};
+    for (size_t size : sizes) {
+        if (size > max_vertices) break;
+        Polygon polygon = generate(size);
+        std::vector<Query> queries = random_queries(polygon, query_count, rng);
+        size_t vertices = vertex_count(polygon);
+
+        Clock::time_point start = Clock::now();
+        bfreeman::PolygonIndex index(polygon);
+        double index_seconds = seconds_since(start);
+
+        bfreeman::IndexOptions table_options;
+        table_options.all_pairs = true;
+        table_options.threads = 0;
+        start = Clock::now();
+        bfreeman::PolygonIndex table_index(polygon, table_options);
+        double table_seconds = seconds_since(start);
+
+        // a double distance and a uint32_t next hop per pair of vertices
+        double table_megabytes = 12.0 * vertices * vertices / (1 << 20);
+
+        bfreeman::QueryOptions options[3];
+        options[1].search = bfreeman::A_STAR;
+        options[2].search = bfreeman::TABLE_LOOKUP;
+        double query_seconds[3];
+        for (size_t o = 0; o < 3; o++) {
+            start = Clock::now();
+            for (size_t k = 0; k < queries.size(); k++) {
+                table_index.dijkstra_path(queries[k].first, queries[k].second, options[o]);
+            }
+            query_seconds[o] = seconds_since(start);
+        }
+
+        std::cout << std::setw(10) << vertices;
+        print_cell(index_seconds, 12);
+        print_cell(table_seconds, 12);
+        print_cell(table_megabytes, 12);
+        print_cell(1e6 * query_seconds[0] / queries.size(), 14);
+        print_cell(1e6 * query_seconds[1] / queries.size(), 10);
+        print_cell(1e6 * query_seconds[2] / queries.size(), 10);
+        std::cout << std::endl;
+    }
+}
+
+/*
+ * Times testing chords between random interior points against
+ * the edges of the polygon at each SimdLevel (a test stops at
+ * the first edge it finds crossing the chord).
+ */
+void bench_intersect(const std::string& name, const Polygon& polygon, const std::vector<Query>& chords) {
+    bfreeman::EdgeBatch edge_batch(polygon);
+    std::cout << name << " (" << edge_batch.size() << " edges, " << chords.size() << " chords)" << std::endl;
+
+    const char* labels[] = {"scalar per edge", "sse2 per edge", "avx2 per edge"};
+    double scalar_seconds = 0;
+    for (int level = bfreeman::SCALAR; level <= bfreeman::simd_level(); level++) {
+        Clock::time_point start = Clock::now();
+        for (size_t k = 0; k < chords.size(); k++) {
+            bfreeman::Segment chord = {chords[k].first, chords[k].second};
+            edge_batch.intersects(chord, 0, edge_batch.size(), (bfreeman::SimdLevel) level);
+        }
+        double seconds = seconds_since(start);
+        if (level == bfreeman::SCALAR) scalar_seconds = seconds;
+        print_row(labels[level], 1e9 * seconds / (chords.size() * edge_batch.size()), "ns");
+        if (level != bfreeman::SCALAR) print_row("  speedup", scalar_seconds / seconds, "x");
+    }
+}
+
+/*
+ * Times deciding whether the chord between every pair of
+ * vertices starts inside the polygon, first with the angle
+ * range of the vertex (as the chord test used to, once per
+ * pair), then with precomputed VertexCones.
+ */
+void bench_cone(const std::string& name, const Polygon& polygon) {
+    size_t vertices = vertex_count(polygon);
+    size_t pairs = vertices * (vertices - 1);
+    std::cout << name << " (" << pairs << " vertex pairs)" << std::endl;
+
+    std::vector<bool> angle_inside, cone_inside;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            for (size_t k = 0; k < polygon.size(); k++) {
+                for (size_t l = 0; l < polygon[k].size(); l++) {
+                    if (i == k && j == l) continue;
+                    bfreeman::Point angle_range = bfreeman::get_angle_range(polygon, bfreeman::IndexPair(i, j));
+                    angle_inside.push_back(bfreeman::pointing_inside((bfreeman::Segment) {polygon[i][j], polygon[k][l]},
+                                                                     angle_range));
+                }
+            }
+        }
+    }
+    double angle_seconds = seconds_since(start);
+
+    start = Clock::now();
+    std::vector<bfreeman::VertexCone> cones = bfreeman::get_vertex_cones(polygon);
+    for (size_t a = 0, i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++, a++) {
+            for (size_t k = 0; k < polygon.size(); k++) {
+                for (size_t l = 0; l < polygon[k].size(); l++) {
+                    if (i == k && j == l) continue;
+                    cone_inside.push_back(bfreeman::pointing_inside(cones[a], polygon[k][l]));
+                }
+            }
+        }
+    }
+    double cone_seconds = seconds_since(start);
+
+    print_row("angle range per pair", 1e9 * angle_seconds / pairs, "ns");
+    print_row("vertex cone per pair", 1e9 * cone_seconds / pairs, "ns");
+    print_row("  speedup", angle_seconds / cone_seconds, "x");
+    size_t disagreements = 0;
+    for (size_t k = 0; k < pairs; k++) {
+        if (angle_inside[k] != cone_inside[k]) disagreements++;
+    }
+    if (disagreements > 0) print_row("disagreements", (double) disagreements, "");
+}
+
+/*
+ * bench [max vertices [queries per size [seconds]]]
+ */
+int main(int argc, char** argv) {
+    ScalingOptions options;
+    if (argc > 1) options.max_vertices = std::strtoul(argv[1], nullptr, 10);
+    if (argc > 2) options.queries = std::strtoul(argv[2], nullptr, 10);
+    if (argc > 3) options.seconds = std::atof(argv[3]);
+    std::mt19937 rng(1);
+
+    // each generator maps a target vertex count to its parameters
+    bench_scaling("random star with holes", [&](size_t size) {
+        size_t holes = size / 9;
+        return star_polygon(std::max<size_t>(size - holes * 9 / 2, 4), holes, rng);
+    }, options, rng);
+    bench_scaling("comb", [](size_t size) {
+        return comb_polygon(std::max<size_t>((size - 4) / 4, 1));
+    }, options, rng);
+    bench_scaling("maze", [&](size_t size) {
+        return maze_polygon(std::max<size_t>((size_t) sqrt(size / 2.0), 1), rng);
+    }, options, rng);
+    bench_scaling("grid of holes", [](size_t size) {
+        return hole_grid_polygon(std::max<size_t>((size_t) sqrt((size - 4) / 4.0), 1));
+    }, options, rng);
+
+    bench_triangulation("triangulation, random star with holes", [&](size_t size) {
+        size_t holes = size / 9;
+        return star_polygon(std::max<size_t>(size - holes * 9 / 2, 4), holes, rng);
+    }, options, rng);
+    bench_triangulation("triangulation, maze", [&](size_t size) {
+        return maze_polygon(std::max<size_t>((size_t) sqrt(size / 2.0), 1), rng);
+    }, options, rng);
+    bench_triangulation("triangulation, grid of holes", [](size_t size) {
+        return hole_grid_polygon(std::max<size_t>((size_t) sqrt((size - 4) / 4.0), 1));
+    }, options, rng);
+
+    bench_table("all-pairs table, random star with holes", [&](size_t size) {
+        size_t holes = size / 9;
+        return star_polygon(std::max<size_t>(size - holes * 9 / 2, 4), holes, rng);
+    }, options.max_vertices, options.queries, rng);
+    std::cout << std::endl;
+
+    Polygon comb = comb_polygon(100);
+    bench_search("comb", comb, random_queries(comb, 200, rng));
+
+    Polygon star = star_polygon(400, 60, rng);
+    bench_search("star with holes", star, random_queries(star, 200, rng));
+
+    bench_tree("star tree", star, random_queries(star, 200, rng));
+
+    bench_obstacles("star obstacles", star, random_queries(star, 200, rng), rng);
+
+    bench_context("star context", star, random_queries(star, 200, rng));
+
+    bench_goals("star nearest goal", star, random_queries(star, 80, rng));
+
+    bench_stream("star stream", star, random_queries(star, 2000, rng));
+
+    Polygon small_star = star_polygon(100, 10, rng);
+    bench_scalars("star scalar types", small_star, random_queries(small_star, 20, rng));
+
+    Polygon large_star = star_polygon(2000, 200, rng);
+    bench_index_file("star index file", large_star, random_queries(large_star, 1, rng));
+    bench_updates("star updates", large_star, random_queries(large_star, 10, rng));
+    bench_fixture("star test file", large_star, 100, rng);
+    bench_locate("star point location", large_star, random_queries(large_star, 20, rng), 100000, rng);
+
+    bench_heap("star heap", star, 1000, rng);
+    bench_heap("hole grid heap", hole_grid_polygon(16), 1000, rng);
+
+    bench_intersect("star edges", star, random_queries(star, 2000, rng));
+
+    bench_cone("star cones", star);
+
+#ifdef DIJKSTRA_POLYGON_STATS
+    bench_stats("star stats", star, random_queries(star, 200, rng));
+#endif
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <cmath>
+#include <cstring>
+#include "edge_batch.hpp"
+#include "edge_batch_x86.hpp"
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+SimdLevel simd_level() {
+#ifdef EDGE_BATCH_X86
+    static const SimdLevel level =
+            __builtin_cpu_supports("avx2") ? AVX2 : (__builtin_cpu_supports("sse2") ? SSE2 : SCALAR);
+    return level;
+#else
+    return SCALAR;
+#endif
+}
+
+EdgeBatch::EdgeBatch(const std::vector<std::vector<Point>>& polygon) {
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            push_back((Segment) {polygon[i][j], polygon[i][(j + 1) % polygon[i].size()]});
+        }
+    }
+}
+
+void EdgeBatch::push_back(const Segment& edge) {
+    x1.push_back(edge.p1.x);
+    y1.push_back(edge.p1.y);
+    x2.push_back(edge.p2.x);
+    y2.push_back(edge.p2.y);
+}
+
+size_t EdgeBatch::size() const {
+    return x1.size();
+}
+
+bool EdgeBatch::intersects(const Segment& segment, const size_t first, const size_t last) const {
+    return intersects(segment, first, last, simd_level());
+}
+
+bool EdgeBatch::intersects(
+        const Segment& segment,
+        const size_t first,
+        const size_t last,
+        const SimdLevel level) const {
+
+    if (last <= first) return false;
+#ifdef EDGE_BATCH_X86
+    SimdLevel supported = simd_level();
+    SimdLevel used = level < supported ? level : supported;
+    size_t count = last - first;
+
+    // fewer edges than fill a vector are cheaper to test one at a time
+    if (used >= AVX2 && count >= 4) {
+        return intersects_avx2(segment, &x1[first], &y1[first], &x2[first], &y2[first], count);
+    }
+    if (used >= SSE2 && count >= 2) {
+        return intersects_sse2(segment, &x1[first], &y1[first], &x2[first], &y2[first], count);
+    }
+#endif
+    for (size_t k = first; k < last; k++) {
+        if (check_intersect(segment, (Segment) {{x1[k], y1[k]}, {x2[k], y2[k]}})) return true;
+    }
+    return false;
+}
+
+bool EdgeBatch::intersects(const Segment& segment) const {
+    return intersects(segment, 0, size());
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include <cmath>
+#include <cstring>
+#include "edge_batch_x86.hpp"
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+#ifdef EDGE_BATCH_X86
+
+/*
+ * The helpers are always inlined, so their vector arguments never
+ * go through a call. GCC still notes the AVX return types as an
+ * ABI change, at the end of the file rather than where they are
+ * declared, so only the kernels live here.
+ */
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace bfreeman {
+
+// lanes of doubles and the all-ones or all-zeros lane masks comparing them gives
+typedef double Double2 __attribute__((vector_size(16)));
+typedef double Double4 __attribute__((vector_size(32)));
+typedef decltype(Double2() < Double2()) Mask2;
+typedef decltype(Double4() < Double4()) Mask4;
+
+/*
+ * The kernels below are written once over GCC vector types and
+ * inlined into a function compiled for each instruction set.
+ * Every expression matches the one check_intersect evaluates,
+ * term for term, so the answers are bit for bit the same.
+ */
+#define KERNEL inline __attribute__((always_inline))
+
+template<typename Vector>
+KERNEL Vector broadcast(const double d) {
+    return d - (Vector) {};
+}
+
+// is_close: fabs(d) < ORIENTATION_EPSILON
+template<typename Mask, typename Vector>
+KERNEL Mask close(const Vector& d) {
+    return (d < ORIENTATION_EPSILON) & (d > -ORIENTATION_EPSILON);
+}
+
+// on_segment, for a box given by its sides
+template<typename Mask, typename Vector>
+KERNEL Mask in_box(const Vector& x, const Vector& y, const Vector& min_x, const Vector& max_x,
+                   const Vector& min_y, const Vector& max_y) {
+    return (x <= max_x) & (x >= min_x) & (y <= max_y) & (y >= min_y);
+}
+
+template<typename Mask>
+KERNEL bool any_lane(const Mask& mask) {
+    long lanes_or = 0;
+    for (size_t lane = 0; lane < sizeof(Mask) / sizeof(mask[0]); lane++) lanes_or |= mask[lane];
+    return lanes_or != 0;
+}
+
+// the chord p -> q and its bounding box, copied into every lane
+template<typename Vector>
+struct Chord {
+    Vector px, py, qx, qy;
+    Vector dx, dy; // q - p, as orientation computes it
+    Vector min_x, max_x, min_y, max_y;
+};
+
+template<typename Vector>
+KERNEL void load_chord(Chord<Vector>& chord, const Segment& segment) {
+    const double px = segment.p1.x, py = segment.p1.y;
+    const double qx = segment.p2.x, qy = segment.p2.y;
+    chord.px = broadcast<Vector>(px);
+    chord.py = broadcast<Vector>(py);
+    chord.qx = broadcast<Vector>(qx);
+    chord.qy = broadcast<Vector>(qy);
+    chord.dx = broadcast<Vector>(qx - px);
+    chord.dy = broadcast<Vector>(qy - py);
+    chord.min_x = broadcast<Vector>(px < qx ? px : qx);
+    chord.max_x = broadcast<Vector>(px > qx ? px : qx);
+    chord.min_y = broadcast<Vector>(py < qy ? py : qy);
+    chord.max_y = broadcast<Vector>(py > qy ? py : qy);
+}
+
+/*
+ * @return the lanes whose edge (x1, y1) -> (x2, y2) the chord
+ *         intersects, as in check_intersect(chord, edge)
+ */
+template<typename Vector, typename Mask>
+KERNEL Mask intersect_lanes(
+        const Chord<Vector>& chord,
+        const Vector& x1, const Vector& y1,
+        const Vector& x2, const Vector& y2) {
+
+    // the values orientation classifies, with the chord as the first segment and then the edge
+    Vector edge_dx = x2 - x1, edge_dy = y2 - y1;
+    Vector v1 = chord.dy * (x1 - chord.qx) - chord.dx * (y1 - chord.qy);
+    Vector v2 = chord.dy * (x2 - chord.qx) - chord.dx * (y2 - chord.qy);
+    Vector v3 = edge_dy * (chord.px - x2) - edge_dx * (chord.py - y2);
+    Vector v4 = edge_dy * (chord.qx - x2) - edge_dx * (chord.qy - y2);
+
+    // each orientation is a pair of masks: COLINEAR, else CLOCKWISE, else COUNTERCLOCKWISE
+    Mask colinear1 = close<Mask>(v1), clockwise1 = ~colinear1 & (v1 > 0.0);
+    Mask colinear2 = close<Mask>(v2), clockwise2 = ~colinear2 & (v2 > 0.0);
+    Mask colinear3 = close<Mask>(v3), clockwise3 = ~colinear3 & (v3 > 0.0);
+    Mask colinear4 = close<Mask>(v4), clockwise4 = ~colinear4 & (v4 > 0.0);
+    Mask crossing = ((colinear1 ^ colinear2) | (clockwise1 ^ clockwise2)) &
+                    ((colinear3 ^ colinear4) | (clockwise3 ^ clockwise4));
+
+    // most edges are neither crossed nor touched, which the orientations alone show
+    Mask colinear = colinear1 | colinear2 | colinear3 | colinear4;
+    if (!any_lane(crossing | colinear)) return crossing;
+
+    // share_endpoint
+    Mask shared = (close<Mask>(chord.px - x1) & close<Mask>(chord.py - y1)) |
+                  (close<Mask>(chord.px - x2) & close<Mask>(chord.py - y2)) |
+                  (close<Mask>(chord.qx - x1) & close<Mask>(chord.qy - y1)) |
+                  (close<Mask>(chord.qx - x2) & close<Mask>(chord.qy - y2));
+
+    // on_segment against the chord, then against the edge
+    Vector min_x = x1 < x2 ? x1 : x2, max_x = x1 > x2 ? x1 : x2;
+    Vector min_y = y1 < y2 ? y1 : y2, max_y = y1 > y2 ? y1 : y2;
+
+    return ~shared & (crossing |
+                      (colinear1 & in_box<Mask>(x1, y1, chord.min_x, chord.max_x, chord.min_y, chord.max_y)) |
+                      (colinear2 & in_box<Mask>(x2, y2, chord.min_x, chord.max_x, chord.min_y, chord.max_y)) |
+                      (colinear3 & in_box<Mask>(chord.px, chord.py, min_x, max_x, min_y, max_y)) |
+                      (colinear4 & in_box<Mask>(chord.qx, chord.qy, min_x, max_x, min_y, max_y)));
+}
+
+template<typename Vector>
+KERNEL void load(Vector& vector, const double* d) {
+    memcpy(&vector, d, sizeof(vector));
+}
+
+// tests a vector of edges per step; the lanes past the last
+// edge are filled with NaN edges, which intersect nothing
+template<typename Vector, typename Mask>
+KERNEL bool intersects_steps(
+        const Segment& segment,
+        const double* x1, const double* y1,
+        const double* x2, const double* y2,
+        const size_t count) {
+
+    const size_t lanes = sizeof(Vector) / sizeof(double);
+    Chord<Vector> chord;
+    load_chord(chord, segment);
+
+    Vector edge_x1, edge_y1, edge_x2, edge_y2;
+    size_t k = 0;
+    for (; k + lanes <= count; k += lanes) {
+        load(edge_x1, x1 + k);
+        load(edge_y1, y1 + k);
+        load(edge_x2, x2 + k);
+        load(edge_y2, y2 + k);
+        STATS_ADD(check_intersect_calls, lanes);
+        if (any_lane(intersect_lanes<Vector, Mask>(chord, edge_x1, edge_y1, edge_x2, edge_y2))) return true;
+    }
+    if (k == count) return false;
+    STATS_ADD(check_intersect_calls, count - k);
+
+    edge_x1 = edge_y1 = edge_x2 = edge_y2 = broadcast<Vector>(NAN);
+    for (size_t lane = 0; k + lane < count; lane++) {
+        edge_x1[lane] = x1[k + lane];
+        edge_y1[lane] = y1[k + lane];
+        edge_x2[lane] = x2[k + lane];
+        edge_y2[lane] = y2[k + lane];
+    }
+    return any_lane(intersect_lanes<Vector, Mask>(chord, edge_x1, edge_y1, edge_x2, edge_y2));
+}
+
+__attribute__((target("sse2")))
+bool intersects_sse2(
+        const Segment& segment,
+        const double* x1, const double* y1,
+        const double* x2, const double* y2,
+        const size_t count) {
+    return intersects_steps<Double2, Mask2>(segment, x1, y1, x2, y2, count);
+}
+
+__attribute__((target("avx2")))
+bool intersects_avx2(
+        const Segment& segment,
+        const double* x1, const double* y1,
+        const double* x2, const double* y2,
+        const size_t count) {
+    return intersects_steps<Double4, Mask4>(segment, x1, y1, x2, y2, count);
+}
+
+} // namespace bfreeman
+
+#endif // #ifdef EDGE_BATCH_X86
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <cmath>
+#include "edge_grid.hpp"
+#include "polygon_geometry.hpp"
+
+namespace bfreeman {
+
+// upper bound on the cells along either side of the grid
+const size_t MAX_GRID_SIDE = 4096;
+
+double clamp(const double d, const double lo, const double hi) {
+    return d < lo ? lo : (d > hi ? hi : d);
+}
+
+size_t cell_idx(const double d, const double origin, const double cell_size, const size_t count) {
+    double idx = floor((d - origin) / cell_size);
+    if (!(idx > 0)) return 0;
+    if (idx >= count - 1) return count - 1;
+    return (size_t) idx;
+}
+
+EdgeGrid::EdgeGrid(const std::vector<std::vector<Point>>& polygon) {
+    Point max = {-__DBL_MAX__, -__DBL_MAX__};
+    origin = {__DBL_MAX__, __DBL_MAX__};
+    min_edge_length = __DBL_MAX__;
+
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            Segment edge = {polygon[i][j], polygon[i][(j + 1) % polygon[i].size()]};
+            edges.push_back(edge);
+            edge_batch.push_back(edge);
+            double edge_length = length(edge);
+            if (edge_length < min_edge_length) min_edge_length = edge_length;
+
+            origin.x = fmin(origin.x, polygon[i][j].x);
+            origin.y = fmin(origin.y, polygon[i][j].y);
+            max.x = fmax(max.x, polygon[i][j].x);
+            max.y = fmax(max.y, polygon[i][j].y);
+        }
+    }
+
+    if (edges.empty()) {
+        origin = {0, 0};
+        max = {0, 0};
+    }
+
+    // aim for about one cell per edge
+    double width = max.x - origin.x;
+    double height = max.y - origin.y;
+    double edge_count = edges.empty() ? 1 : (double) edges.size();
+    if (width > 0 && height > 0) {
+        cell_size = sqrt(width * height / edge_count);
+    } else {
+        cell_size = fmax(width, height) / edge_count;
+    }
+    if (!(cell_size > 0)) cell_size = 1;
+    cell_size = fmax(cell_size, fmax(width, height) / MAX_GRID_SIDE);
+
+    columns = (size_t) (width / cell_size) + 1;
+    rows = (size_t) (height / cell_size) + 1;
+    if (columns > MAX_GRID_SIDE) columns = MAX_GRID_SIDE;
+    if (rows > MAX_GRID_SIDE) rows = MAX_GRID_SIDE;
+
+    // bucket the edges by cell: count, prefix sum, then fill
+    double build_margin = cell_size * 10e-10;
+    cell_offsets.assign(columns * rows + 1, 0);
+    for (size_t e = 0; e < edges.size(); e++) {
+        visit_cells(edges[e], build_margin, [&](size_t cell) {
+            cell_offsets[cell + 1]++;
+            return false;
+        });
+    }
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        cell_offsets[cell + 1] += cell_offsets[cell];
+    }
+
+    std::vector<size_t> fill = cell_offsets;
+    std::vector<size_t> edge_idxs(cell_offsets.back());
+    for (size_t e = 0; e < edges.size(); e++) {
+        visit_cells(edges[e], build_margin, [&](size_t cell) {
+            edge_idxs[fill[cell]++] = e;
+            return false;
+        });
+    }
+    for (size_t k = 0; k < edge_idxs.size(); k++) {
+        cell_edges.push_back(edges[edge_idxs[k]]);
+    }
+}
+
+template<typename Visit>
+bool EdgeGrid::visit_cells(const Segment& segment, const double margin, Visit visit) const {
+    double min_x = fmin(segment.p1.x, segment.p2.x);
+    double max_x = fmax(segment.p1.x, segment.p2.x);
+    double min_y = fmin(segment.p1.y, segment.p2.y);
+    double max_y = fmax(segment.p1.y, segment.p2.y);
+    double dx = segment.p2.x - segment.p1.x;
+
+    auto y_at = [&](const double x) {
+        if (dx == 0) return segment.p1.y;
+        return clamp(segment.p1.y + (x - segment.p1.x) * (segment.p2.y - segment.p1.y) / dx, min_y, max_y);
+    };
+
+    size_t first_column = cell_idx(min_x - margin, origin.x, cell_size, columns);
+    size_t last_column = cell_idx(max_x + margin, origin.x, cell_size, columns);
+
+    for (size_t column = first_column; column <= last_column; column++) {
+        // the part of the segment that lies within margin of this column
+        double slab_min = origin.x + column * cell_size - margin;
+        double slab_max = slab_min + cell_size + 2 * margin;
+        double y1 = dx == 0 ? min_y : y_at(clamp(slab_min, min_x, max_x));
+        double y2 = dx == 0 ? max_y : y_at(clamp(slab_max, min_x, max_x));
+
+        size_t first_row = cell_idx(fmin(y1, y2) - margin, origin.y, cell_size, rows);
+        size_t last_row = cell_idx(fmax(y1, y2) + margin, origin.y, cell_size, rows);
+
+        for (size_t row = first_row; row <= last_row; row++) {
+            if (visit(row * columns + column)) return true;
+        }
+    }
+    return false;
+}
+
+bool EdgeGrid::intersects(const Segment& segment) const {
+    /*
+     * orientation treats cross products below ORIENTATION_EPSILON as
+     * colinear, so check_intersect may report edges up to about
+     * ORIENTATION_EPSILON / (shorter segment length) away from segment
+     * (and long, nearly parallel edges further away, see edge_grid.hpp)
+     */
+    double shortest = fmin(length(segment), min_edge_length);
+    double margin = cell_size * 10e-10 + 2 * ORIENTATION_EPSILON / shortest;
+
+    if (!(margin < cell_size * (columns + rows))) return edge_batch.intersects(segment);
+
+    // walk the cells from the same end both ways, so a chord and its
+    // reverse are tested against the same edges
+    bool reverse = segment.p2.x < segment.p1.x || (segment.p2.x == segment.p1.x && segment.p2.y < segment.p1.y);
+    Segment walk = reverse ? (Segment) {segment.p2, segment.p1} : segment;
+
+    // an edge spanning several cells is tested once in each, which is
+    // cheaper than tracking the edges already tested
+    return visit_cells(walk, margin, [&](size_t cell) {
+        return cell_edges.intersects(segment, cell_offsets[cell], cell_offsets[cell + 1]);
+    });
+}
+
+} // namespace bfreeman
\ No newline at end of file
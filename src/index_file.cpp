@@ -0,0 +1,92 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "index_file.hpp"
+#include "dijkstra_polygon.hpp"
+
+namespace bfreeman {
+
+// the sections are read in place as these types
+static_assert(sizeof(size_t) == sizeof(uint64_t), "CompactGraph::offsets must be 64-bit");
+static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+static_assert(sizeof(IndexFileHeader) % 8 == 0, "sections must start 8-byte aligned");
+
+size_t align_8(const size_t bytes) {
+    return (bytes + 7) & ~(size_t) 7;
+}
+
+IndexFileLayout index_file_layout(const IndexFileHeader& header) {
+    size_t node_count = header.vertex_count + 2;
+    size_t table_size = (header.flags & INDEX_FILE_ALL_PAIRS) ? header.vertex_count * header.vertex_count : 0;
+
+    IndexFileLayout layout;
+    layout.ring_sizes = sizeof(IndexFileHeader);
+    layout.vertices = layout.ring_sizes + align_8(header.ring_count * sizeof(uint64_t));
+    layout.reflex = layout.vertices + align_8(header.vertex_count * sizeof(Point));
+    layout.offsets = layout.reflex + align_8(header.vertex_count * sizeof(uint8_t));
+    layout.targets = layout.offsets + align_8((node_count + 1) * sizeof(uint64_t));
+    layout.weights = layout.targets + align_8(header.edge_count * sizeof(uint32_t));
+    layout.table_distances = layout.weights + align_8(header.edge_count * sizeof(double));
+    layout.table_next = layout.table_distances + align_8(table_size * sizeof(double));
+    layout.file_size = layout.table_next + align_8(table_size * sizeof(uint32_t));
+    return layout;
+}
+
+// one 64-bit word into the hash, mixed as in MurmurHash3's finalizer steps
+uint64_t mix_word(uint64_t hash, const uint64_t word) {
+    hash ^= word * 0x9E3779B97F4A7C15ULL;
+    hash = (hash << 31) | (hash >> 33);
+    return hash * 0xC2B2AE3D27D4EB4FULL;
+}
+
+uint64_t index_file_checksum(uint64_t hash, const void* data, const size_t size) {
+    const uint8_t* bytes = (const uint8_t*) data;
+    size_t full_words = size / 8;
+    for (size_t k = 0; k < full_words; k++) {
+        uint64_t word;
+        memcpy(&word, bytes + 8 * k, 8);
+        hash = mix_word(hash, word);
+    }
+    if (size % 8 != 0) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + 8 * full_words, size % 8);
+        hash = mix_word(hash, word);
+    }
+    return hash;
+}
+
+MappedFile::MappedFile(const std::string& path) : memory(nullptr), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void* mapped = mmap(nullptr, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            memory = mapped;
+            length = (size_t) file_stat.st_size;
+        }
+    }
+    // the mapping stays valid once the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (memory != nullptr) munmap(memory, length);
+}
+
+bool MappedFile::is_open() const {
+    return memory != nullptr;
+}
+
+const uint8_t* MappedFile::data() const {
+    return (const uint8_t*) memory;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "indexed_heap.hpp"
+
+namespace bfreeman {
+
+const uint32_t SETTLED = UINT32_MAX;
+
+bool IndexedHeap::precedes(const Entry& e1, const Entry& e2) {
+    if (e1.key != e2.key) return e1.key < e2.key;
+    return e1.idx < e2.idx;
+}
+
+void IndexedHeap::reset(const size_t node_count) {
+    heap.clear();
+    if (stamps.size() < node_count) {
+        slots.resize(node_count);
+        stamps.resize(node_count, epoch);
+    }
+
+    // a stamp left over from an epoch that wrapped around would look current
+    if (++epoch == 0) {
+        stamps.assign(stamps.size(), 0);
+        epoch = 1;
+    }
+}
+
+bool IndexedHeap::empty() const {
+    return heap.empty();
+}
+
+void IndexedHeap::push_or_decrease(const uint32_t idx, const double key) {
+    if (stamps[idx] != epoch) {
+        stamps[idx] = epoch;
+        heap.push_back((Entry) {key, idx});
+        sift_up(heap.size() - 1, heap.back());
+    } else if (slots[idx] != SETTLED) {
+        sift_up(slots[idx], (Entry) {key, idx});
+    }
+}
+
+uint32_t IndexedHeap::pop() {
+    uint32_t idx = heap[0].idx;
+    slots[idx] = SETTLED;
+
+    Entry last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) sift_down(0, last);
+    return idx;
+}
+
+double IndexedHeap::top_key() const {
+    return heap[0].key;
+}
+
+bool IndexedHeap::is_settled(const uint32_t idx) const {
+    return stamps[idx] == epoch && slots[idx] == SETTLED;
+}
+
+// moves the entries above slot down until entry fits, then places it
+void IndexedHeap::sift_up(size_t slot, const Entry entry) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / ARITY;
+        if (!precedes(entry, heap[parent])) break;
+        heap[slot] = heap[parent];
+        slots[heap[slot].idx] = (uint32_t) slot;
+        slot = parent;
+    }
+    heap[slot] = entry;
+    slots[entry.idx] = (uint32_t) slot;
+}
+
+// moves the smallest child below slot up until entry fits, then places it
+void IndexedHeap::sift_down(size_t slot, const Entry entry) {
+    while (true) {
+        size_t first_child = ARITY * slot + 1;
+        if (first_child >= heap.size()) break;
+        size_t last_child = first_child + ARITY < heap.size() ? first_child + ARITY : heap.size();
+
+        size_t min_child = first_child;
+        for (size_t child = first_child + 1; child < last_child; child++) {
+            if (precedes(heap[child], heap[min_child])) min_child = child;
+        }
+        if (!precedes(heap[min_child], entry)) break;
+
+        heap[slot] = heap[min_child];
+        slots[heap[slot].idx] = (uint32_t) slot;
+        slot = min_child;
+    }
+    heap[slot] = entry;
+    slots[entry.idx] = (uint32_t) slot;
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include "obstacle_set.hpp"
+#include "polygon_geometry.hpp"
+
+namespace bfreeman {
+
+ObstacleSet::ObstacleSet(const std::vector<std::vector<Point>>& obstacles) : obstacles(obstacles) {
+    edge_offsets.push_back(0);
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        Point min = {__DBL_MAX__, __DBL_MAX__}, max = {-__DBL_MAX__, -__DBL_MAX__};
+        for (size_t j = 0; j < obstacles[i].size(); j++) {
+            edges.push_back((Segment) {obstacles[i][j], obstacles[i][(j + 1) % obstacles[i].size()]});
+            min.x = std::min(min.x, obstacles[i][j].x);
+            min.y = std::min(min.y, obstacles[i][j].y);
+            max.x = std::max(max.x, obstacles[i][j].x);
+            max.y = std::max(max.y, obstacles[i][j].y);
+        }
+        edge_offsets.push_back(edges.size());
+        box_min.push_back(min);
+        box_max.push_back(max);
+    }
+}
+
+bool ObstacleSet::blocks(const Segment& segment) const {
+    Point min = {std::min(segment.p1.x, segment.p2.x), std::min(segment.p1.y, segment.p2.y)};
+    Point max = {std::max(segment.p1.x, segment.p2.x), std::max(segment.p1.y, segment.p2.y)};
+    Point midpoint = {(segment.p1.x + segment.p2.x) / 2, (segment.p1.y + segment.p2.y) / 2};
+
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        // the tolerances of check_intersect reach a little past the box
+        if (min.x > box_max[i].x + ORIENTATION_EPSILON || max.x < box_min[i].x - ORIENTATION_EPSILON ||
+            min.y > box_max[i].y + ORIENTATION_EPSILON || max.y < box_min[i].y - ORIENTATION_EPSILON) {
+            continue;
+        }
+        if (edges.intersects(segment, edge_offsets[i], edge_offsets[i + 1])) return true;
+
+        // crossing no edge, the segment is either wholly inside the obstacle or wholly outside it
+        if (contains(midpoint)) return true;
+    }
+    return false;
+}
+
+bool ObstacleSet::contains(const Point& point) const {
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        if (point.x < box_min[i].x || point.x > box_max[i].x || point.y < box_min[i].y || point.y > box_max[i].y) {
+            continue;
+        }
+
+        // even-odd rule: count the edges a ray from point to the right crosses
+        const std::vector<Point>& obstacle = obstacles[i];
+        bool inside = false;
+        for (size_t j = 0, k = obstacle.size() - 1; j < obstacle.size(); k = j++) {
+            if ((obstacle[j].y > point.y) != (obstacle[k].y > point.y) &&
+                point.x < obstacle[j].x + (point.y - obstacle[j].y) * (obstacle[k].x - obstacle[j].x) /
+                                          (obstacle[k].y - obstacle[j].y)) {
+                inside = !inside;
+            }
+        }
+        if (inside) return true;
+    }
+    return false;
+}
+
+bool ObstacleSet::empty() const {
+    return obstacles.empty();
+}
+
+const std::vector<std::vector<Point>>& ObstacleSet::get_obstacles() const {
+    return obstacles;
+}
+
+} // namespace bfreeman
\ No newline at end of file
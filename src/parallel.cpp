@@ -0,0 +1,68 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+size_t worker_count(const size_t threads) {
+    if (threads > 0) return threads;
+    size_t hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+void parallel_for(
+        const size_t count,
+        const size_t threads,
+        const size_t chunk,
+        const std::function<void(size_t)>& body) {
+
+    parallel_for(count, threads, chunk, [&](size_t, size_t idx) {
+        body(idx);
+    });
+}
+
+void parallel_for(
+        const size_t count,
+        const size_t threads,
+        const size_t chunk,
+        const std::function<void(size_t, size_t)>& body) {
+
+    if (count == 0) return;
+    size_t chunk_size = chunk > 0 ? chunk : 1;
+    size_t workers = worker_count(threads);
+    size_t chunks = (count + chunk_size - 1) / chunk_size;
+    if (workers > chunks) workers = chunks;
+
+    // each worker counts into its own stats, added to the caller's once all are joined
+    QueryStats* caller_stats = current_stats();
+    std::vector<QueryStats> worker_stats(caller_stats ? workers : 0);
+
+    std::atomic<size_t> next_idx(0);
+    auto work = [&](const size_t worker) {
+        StatsScope stats_scope(caller_stats ? &worker_stats[worker] : nullptr);
+        size_t begin;
+        while ((begin = next_idx.fetch_add(chunk_size)) < count) {
+            size_t end = begin + chunk_size < count ? begin + chunk_size : count;
+            for (size_t idx = begin; idx < end; idx++) {
+                body(worker, idx);
+            }
+        }
+    };
+
+    // the calling thread is one of the workers
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < workers; i++) {
+        pool.emplace_back(work, i);
+    }
+    work(0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    for (size_t i = 0; i < worker_stats.size(); i++) {
+        *caller_stats += worker_stats[i];
+    }
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cmath>
+#include "point_location.hpp"
+#include "polygon_geometry.hpp"
+
+namespace bfreeman {
+
+// upper bound on the bands of a PointLocator
+const size_t MAX_LOCATOR_BANDS = 4096;
+
+// bands per square root of the edge count, so a band holds a few times the edges a line across the polygon meets
+const double BANDS_PER_ROOT_EDGE = 4;
+
+// doublings of the distance snap moves a point off an edge before it gives up
+const size_t MAX_SNAP_STEPS = 64;
+
+PointLocator::PointLocator(const std::vector<std::vector<Point>>& polygon) {
+    min = {__DBL_MAX__, __DBL_MAX__};
+    max = {-__DBL_MAX__, -__DBL_MAX__};
+    for (size_t i = 0; i < polygon.size(); i++) {
+        first_edge.push_back(edges.size());
+        double twice_area = 0;
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            const Point& p = polygon[i][j];
+            const Point& q = polygon[i][(j + 1) % polygon[i].size()];
+            edges.push_back((Segment) {p, q});
+            ring_of.push_back((uint32_t) i);
+            twice_area += p.x * q.y - q.x * p.y;
+
+            min.x = fmin(min.x, p.x);
+            min.y = fmin(min.y, p.y);
+            max.x = fmax(max.x, p.x);
+            max.y = fmax(max.y, p.y);
+        }
+        counterclockwise.push_back(twice_area > 0);
+    }
+    first_edge.push_back(edges.size());
+    if (edges.empty()) return;
+
+    double height = max.y - min.y;
+    bands = (size_t) (BANDS_PER_ROOT_EDGE * sqrt((double) edges.size())) + 1;
+    if (bands > MAX_LOCATOR_BANDS) bands = MAX_LOCATOR_BANDS;
+    band_height = height / bands;
+    if (!(band_height > 0)) {
+        bands = 1;
+        band_height = 1;
+    }
+
+    // bucket the edges by band: count, prefix sum, fill, then sort each band by smallest x
+    band_offsets.assign(bands + 1, 0);
+    for (size_t e = 0; e < edges.size(); e++) {
+        size_t last = band_idx(fmax(edges[e].p1.y, edges[e].p2.y));
+        for (size_t b = band_idx(fmin(edges[e].p1.y, edges[e].p2.y)); b <= last; b++) band_offsets[b + 1]++;
+    }
+    for (size_t b = 0; b < bands; b++) {
+        band_offsets[b + 1] += band_offsets[b];
+    }
+
+    std::vector<size_t> fill(band_offsets.begin(), band_offsets.end() - 1);
+    band_edges.resize(band_offsets.back());
+    for (size_t e = 0; e < edges.size(); e++) {
+        BandEdge band_edge = {edges[e], fmin(edges[e].p1.x, edges[e].p2.x), (uint32_t) e};
+        size_t last = band_idx(fmax(edges[e].p1.y, edges[e].p2.y));
+        for (size_t b = band_idx(fmin(edges[e].p1.y, edges[e].p2.y)); b <= last; b++) {
+            band_edges[fill[b]++] = band_edge;
+        }
+    }
+    for (size_t b = 0; b < bands; b++) {
+        std::sort(band_edges.begin() + band_offsets[b], band_edges.begin() + band_offsets[b + 1],
+                  [](const BandEdge& lhs, const BandEdge& rhs) { return lhs.min_x < rhs.min_x; });
+    }
+}
+
+size_t PointLocator::band_idx(const double y) const {
+    double b = floor((y - min.y) / band_height);
+    if (!(b > 0)) return 0;
+    return b >= bands - 1 ? bands - 1 : (size_t) b;
+}
+
+PointLocation PointLocator::locate(const Point& point) const {
+    PointLocation location = {POINT_OUTSIDE, 0, 0};
+
+    // on_segment only holds within an edge's bounding box, so nothing outside the polygon's is on an edge
+    if (bands == 0 || !(point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y)) {
+        return location;
+    }
+
+    /*
+     * The ray runs just above point.y (so a vertex at point.y
+     * counts as below it), and an edge is crossed if it has
+     * one end on either side. Where two edges are crossed at
+     * the same vertex, the one leaning further left is crossed
+     * first just above it.
+     */
+    const BandEdge* nearest = nullptr;
+    double nearest_x = __DBL_MAX__;
+    double nearest_slope = __DBL_MAX__;
+    size_t b = band_idx(point.y);
+    for (size_t k = band_offsets[b]; k < band_offsets[b + 1]; k++) {
+        const BandEdge& band_edge = band_edges[k];
+        // sorted by smallest x, so every edge from here on is further along the ray
+        if (band_edge.min_x > nearest_x) break;
+
+        const Point& a = band_edge.segment.p1;
+        const Point& c = band_edge.segment.p2;
+        if (on_segment(band_edge.segment, point) && orientation(a, c, point) == COLINEAR) {
+            location.point_class = POINT_ON_EDGE;
+            location.ring = ring_of[band_edge.edge];
+            location.edge = band_edge.edge - first_edge[location.ring];
+            return location;
+        }
+        if ((a.y > point.y) == (c.y > point.y)) continue;
+
+        double x;
+        if (a.y == point.y) {
+            x = a.x;
+        } else if (c.y == point.y) {
+            x = c.x;
+        } else {
+            x = a.x + (point.y - a.y) * (c.x - a.x) / (c.y - a.y);
+        }
+        if (x < point.x) continue;
+
+        double slope = (c.x - a.x) / (c.y - a.y);
+        if (x < nearest_x || (x == nearest_x && slope < nearest_slope)) {
+            nearest = &band_edge;
+            nearest_x = x;
+            nearest_slope = slope;
+        }
+    }
+    if (nearest == nullptr) return location;
+
+    // point is left of an edge running up, which is inside a counterclockwise ring
+    size_t ring = ring_of[nearest->edge];
+    bool inside_ring = (nearest->segment.p2.y > nearest->segment.p1.y) == counterclockwise[ring];
+    if (ring == 0) {
+        location.point_class = inside_ring ? POINT_INSIDE : POINT_OUTSIDE;
+    } else if (inside_ring) {
+        location.point_class = POINT_IN_HOLE;
+        location.ring = ring;
+    } else {
+        location.point_class = POINT_INSIDE;
+    }
+    return location;
+}
+
+template<typename Visit>
+void PointLocator::visit_nearby(const Point& point, Visit visit) const {
+    double nearest = __DBL_MAX__;
+    size_t center = band_idx(point.y);
+
+    // how far band b is from point in y, shaded down a little for the rounding in band_idx
+    auto gap = [&](const size_t b) {
+        double low = min.y + b * band_height, high = low + band_height;
+        return fmax(0, fmax(low - point.y, point.y - high)) - band_height * 10e-10;
+    };
+
+    // the gaps only grow moving out from center, so once neither side is near enough nothing further is
+    for (size_t d = 0; d < bands; d++) {
+        bool below = d <= center && gap(center - d) <= nearest;
+        bool above = d > 0 && center + d < bands && gap(center + d) <= nearest;
+        if (!below && !above) break;
+        if (below) {
+            for (size_t k = band_offsets[center - d]; k < band_offsets[center - d + 1]; k++) {
+                nearest = visit(band_edges[k]);
+            }
+        }
+        if (above) {
+            for (size_t k = band_offsets[center + d]; k < band_offsets[center + d + 1]; k++) {
+                nearest = visit(band_edges[k]);
+            }
+        }
+    }
+}
+
+bool PointLocator::snap(Point& point) const {
+    PointLocation location = locate(point);
+    if (location.point_class == POINT_INSIDE) return true;
+    if (bands == 0 || std::isnan(point.x) || std::isnan(point.y)) return false;
+
+    // the point of segment nearest to point, and how far along segment it is
+    auto project = [&](const Segment& segment, double& s) {
+        double dx = segment.p2.x - segment.p1.x, dy = segment.p2.y - segment.p1.y;
+        double length_sq = dx * dx + dy * dy;
+        s = length_sq > 0 ? ((point.x - segment.p1.x) * dx + (point.y - segment.p1.y) * dy) / length_sq : 0;
+        s = fmin(fmax(s, 0), 1);
+        return (Point) {segment.p1.x + s * dx, segment.p1.y + s * dy};
+    };
+
+    // the nearest point on the ring point is outside of (or the edge it is on), and the edge holding it
+    size_t ring = location.point_class == POINT_OUTSIDE ? 0 : location.ring;
+    size_t nearest_edge = first_edge[ring] + location.edge;
+    double t;
+    Point foot = project(edges[nearest_edge], t);
+    if (location.point_class != POINT_ON_EDGE) {
+        double nearest = __DBL_MAX__;
+        visit_nearby(point, [&](const BandEdge& band_edge) {
+            if (ring_of[band_edge.edge] != ring) return nearest;
+            double s;
+            Point on_edge = project(band_edge.segment, s);
+            double distance = sqrt(sq(point.x - on_edge.x) + sq(point.y - on_edge.y));
+            if (distance < nearest) {
+                nearest = distance;
+                nearest_edge = band_edge.edge;
+                foot = on_edge;
+                t = s;
+            }
+            return nearest;
+        });
+        if (nearest == __DBL_MAX__) return false;
+    }
+
+    // the unit normal of edge e pointing off the ring into the polygon
+    auto inward = [&](const size_t e) {
+        double dx = edges[e].p2.x - edges[e].p1.x, dy = edges[e].p2.y - edges[e].p1.y;
+        double norm = sqrt(dx * dx + dy * dy);
+        if (!(norm > 0)) return (Point) {0, 0};
+        // the polygon is left of the boundary's edges if it winds counterclockwise, and right of a hole's
+        double side = (ring == 0) == counterclockwise[ring] ? 1 : -1;
+        return (Point) {-dy / norm * side, dx / norm * side};
+    };
+    Point direction = inward(nearest_edge);
+
+    // at a vertex, split the difference with the edge on its other side
+    size_t ring_size = first_edge[ring + 1] - first_edge[ring];
+    size_t j = nearest_edge - first_edge[ring];
+    if (t <= 0 || t >= 1) {
+        size_t other = first_edge[ring] + (t <= 0 ? (j + ring_size - 1) % ring_size : (j + 1) % ring_size);
+        Point other_direction = inward(other);
+        Point sum = {direction.x + other_direction.x, direction.y + other_direction.y};
+        double norm = sqrt(sq(sum.x) + sq(sum.y));
+        if (norm > 10e-10) direction = {sum.x / norm, sum.y / norm};
+    }
+
+    double extent = fmax(max.x - min.x, max.y - min.y);
+    double scale = fmax(extent, fmax(fmax(fabs(min.x), fabs(max.x)), fmax(fabs(min.y), fabs(max.y))));
+    double step = (scale > 0 ? scale : 1) * 10e-14;
+    for (size_t k = 0; k < MAX_SNAP_STEPS && step <= extent; k++, step *= 2) {
+        Point candidate = {foot.x + direction.x * step, foot.y + direction.y * step};
+        if (locate(candidate).point_class == POINT_INSIDE) {
+            point = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PointLocator::resolve(Point& point, const EndpointPolicy policy) const {
+    if (policy == TRUST_ENDPOINTS) return true;
+    if (policy == SNAP_ENDPOINTS) return snap(point);
+    return locate(point).point_class == POINT_INSIDE;
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include <cmath>
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+bool is_close(const double a, const double b) {
+    return fabs(a - b) < ORIENTATION_EPSILON;
+}
+
+template<typename T>
+bool operator==(const BasicPoint<T>& p, const BasicPoint<T>& q) {
+    if constexpr (ScalarTraits<T>::exact) {
+        return p.x == q.x && p.y == q.y;
+    } else {
+        return is_close(p.x, q.x) && is_close(p.y, q.y);
+    }
+}
+
+void operator-=(Point& p, const Point& q) {
+    p.x -= q.x;
+    p.y -= q.y;
+}
+
+double sq(const double d) {
+    return d * d;
+}
+
+template<typename T>
+typename ScalarTraits<T>::Distance length(const BasicSegment<T>& seg) {
+    // squared in double, as two int32_t differences squared and summed can reach 2^63
+    double dx = (double) seg.p1.x - seg.p2.x;
+    double dy = (double) seg.p1.y - seg.p2.y;
+    return (typename ScalarTraits<T>::Distance) sqrt(dx * dx + dy * dy);
+}
+
+bool is_neighbor_idx(size_t i, size_t j, const size_t size) {
+    // get the larger as i and smaller as j
+    size_t temp = i > j ? i : j;
+    j = j < i ? j : i;
+    i = temp;
+    return i - j == 1 || i - j == size - 1;
+}
+
+template<typename T>
+Orientation orientation(const BasicPoint<T>& p, const BasicPoint<T>& q, const BasicPoint<T>& r) {
+    using Wide = typename ScalarTraits<T>::Wide;
+    Wide value = ((Wide) q.y - p.y) * ((Wide) r.x - q.x) - ((Wide) q.x - p.x) * ((Wide) r.y - q.y);
+    bool colinear;
+    if constexpr (ScalarTraits<T>::exact) {
+        colinear = value == 0;
+    } else {
+        colinear = is_close(value, 0.0);
+    }
+    if (colinear) {
+        return COLINEAR;
+    } else {
+        return value > 0 ? CLOCKWISE : COUNTERCLOCKWISE;
+    }
+}
+
+template<typename T>
+bool share_endpoint(const BasicSegment<T>& seg1, const BasicSegment<T>& seg2) {
+    return (
+            seg1.p1 == seg2.p1 ||
+            seg1.p1 == seg2.p2 ||
+            seg1.p2 == seg2.p1 ||
+            seg1.p2 == seg2.p2
+    );
+}
+
+template<typename T>
+bool on_segment(const BasicSegment<T>& seg, const BasicPoint<T>& p) {
+    auto max = [](T a, T b) {
+        return a > b ? a : b;
+    };
+    auto min = [](T a, T b) {
+        return a < b ? a : b;
+    };
+    return (p.x <= max(seg.p1.x, seg.p2.x) && p.x >= min(seg.p1.x, seg.p2.x) &&
+            p.y <= max(seg.p1.y, seg.p2.y) && p.y >= min(seg.p1.y, seg.p2.y));
+}
+
+template<typename T>
+bool check_intersect(const BasicSegment<T>& seg1, const BasicSegment<T>& seg2) {
+    STATS_ADD(check_intersect_calls, 1);
+    if (share_endpoint(seg1, seg2)) return false;
+    Orientation o1 = orientation(seg1.p1, seg1.p2, seg2.p1);
+    Orientation o2 = orientation(seg1.p1, seg1.p2, seg2.p2);
+    Orientation o3 = orientation(seg2.p1, seg2.p2, seg1.p1);
+    Orientation o4 = orientation(seg2.p1, seg2.p2, seg1.p2);
+    return (o1 != o2 && o3 != o4) ||
+           (o1 == COLINEAR && on_segment(seg1, seg2.p1)) ||
+           (o2 == COLINEAR && on_segment(seg1, seg2.p2)) ||
+           (o3 == COLINEAR && on_segment(seg2, seg1.p1)) ||
+           (o4 == COLINEAR && on_segment(seg2, seg1.p2));
+}
+
+double get_relative_angle(const Point& origin, Point angle_point) {
+    angle_point -= origin;
+    if (is_close(angle_point.x, 0)) {
+        if (angle_point.y > 0) {
+            return M_PI / 2;
+        } else {
+            return 3 * M_PI / 2;
+        }
+    }
+    if (is_close(angle_point.y, 0)) {
+        if (angle_point.x > 0) {
+            return 2 * M_PI;
+        } else {
+            return M_PI;
+        }
+    }
+
+    if (angle_point.x < 0 && angle_point.y < 0) {
+        angle_point.x *= -1;
+        angle_point.y *= -1;
+        return M_PI + atan(angle_point.y / angle_point.x);
+    } else if (angle_point.x < 0) {
+        angle_point.x *= -1;
+        return M_PI - atan(angle_point.y / angle_point.x);
+    } else if (angle_point.y < 0) {
+        angle_point.y *= -1;
+        return 2 * M_PI - atan(angle_point.y / angle_point.x);
+    } else {
+        return atan(angle_point.y / angle_point.x);
+    }
+}
+
+Point get_angle_range(const std::vector<std::vector<Point>>& polygon, const IndexPair& idxp) {
+    // assumes a clockwise winding
+    Point point_prev = polygon[idxp.i][(idxp.j == 0 ? polygon[idxp.i].size() : idxp.j) - 1];
+    Point point = polygon[idxp.i][idxp.j];
+    Point point_next = polygon[idxp.i][idxp.j == polygon[idxp.i].size() - 1 ? 0 : idxp.j + 1];
+
+    double angle_prev = get_relative_angle(point, point_prev);
+    double angle_next = get_relative_angle(point, point_next);
+
+    // holes should check the angle range on the exterior
+    if (idxp.i > 0) {
+        double temp = angle_next;
+        angle_next = angle_prev;
+        angle_prev = temp;
+    }
+
+    if (angle_next < angle_prev) {
+        return (Point) {angle_next, angle_prev};
+    } else {
+        return (Point) {angle_next - 2 * M_PI, angle_prev};
+    }
+}
+
+bool pointing_inside(Segment segment, const Point& angle_range) {
+    double angle = get_relative_angle(segment.p1, segment.p2);
+    if (angle_range.x <= angle && angle <= angle_range.y) return true;
+    angle -= 2 * M_PI;
+    return angle_range.x <= angle && angle <= angle_range.y;
+}
+
+template<typename T>
+BasicVertexCone<T> get_vertex_cone(const std::vector<std::vector<BasicPoint<T>>>& polygon, const IndexPair& idxp) {
+    size_t size = polygon[idxp.i].size();
+    BasicPoint<T> point_prev = polygon[idxp.i][(idxp.j + size - 1) % size];
+    BasicPoint<T> point = polygon[idxp.i][idxp.j];
+    BasicPoint<T> point_next = polygon[idxp.i][(idxp.j + 1) % size];
+
+    // the interior is left of the boundary edges but right of the hole edges
+    BasicVertexCone<T> cone;
+    cone.vertex = point;
+    cone.from = idxp.i == 0 ? point_next : point_prev;
+    cone.to = idxp.i == 0 ? point_prev : point_next;
+    cone.convex = orientation(point, cone.from, cone.to) != CLOCKWISE;
+    return cone;
+}
+
+template<typename T>
+std::vector<BasicVertexCone<T>> get_vertex_cones(const std::vector<std::vector<BasicPoint<T>>>& polygon) {
+    std::vector<BasicVertexCone<T>> cones;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            cones.push_back(get_vertex_cone(polygon, IndexPair(i, j)));
+        }
+    }
+    return cones;
+}
+
+template<typename T>
+bool pointing_inside(const BasicVertexCone<T>& cone, const BasicPoint<T>& point) {
+    bool after_from = orientation(cone.vertex, cone.from, point) != CLOCKWISE;
+    bool before_to = orientation(cone.vertex, cone.to, point) != COUNTERCLOCKWISE;
+    // a convex cone is where both half-planes overlap, a reflex one is either
+    return cone.convex ? after_from && before_to : after_from || before_to;
+}
+
+template<typename T>
+bool is_reflex_vertex(const std::vector<std::vector<BasicPoint<T>>>& polygon, const IndexPair& idxp) {
+    size_t size = polygon[idxp.i].size();
+    BasicPoint<T> point_prev = polygon[idxp.i][(idxp.j + size - 1) % size];
+    BasicPoint<T> point = polygon[idxp.i][idxp.j];
+    BasicPoint<T> point_next = polygon[idxp.i][(idxp.j + 1) % size];
+
+    // both are wound counterclockwise, but holes are seen from the outside
+    Orientation turn = orientation(point_prev, point, point_next);
+    return idxp.i == 0 ? turn == CLOCKWISE : turn == COUNTERCLOCKWISE;
+}
+
+template<typename T>
+bool is_tangent(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const IndexPair& idxp,
+        const BasicPoint<T>& other) {
+
+    size_t size = polygon[idxp.i].size();
+    BasicPoint<T> point_prev = polygon[idxp.i][(idxp.j + size - 1) % size];
+    BasicPoint<T> point = polygon[idxp.i][idxp.j];
+    BasicPoint<T> point_next = polygon[idxp.i][(idxp.j + 1) % size];
+
+    Orientation side_prev = orientation(point, other, point_prev);
+    Orientation side_next = orientation(point, other, point_next);
+    return !((side_prev == CLOCKWISE && side_next == COUNTERCLOCKWISE) ||
+             (side_prev == COUNTERCLOCKWISE && side_next == CLOCKWISE));
+}
+
+template<typename T>
+bool is_interior_chord_start_or_end(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const BasicSegment<T>& segment) {
+
+    for (size_t i = 0; i < polygon.size(); i++) {
+        size_t curr_idx = 0;
+        // do-while goes through every set of consecutive indices
+        do {
+            size_t next_idx = (curr_idx + 1) % polygon[i].size();
+            BasicSegment<T> seg_other = {polygon[i][curr_idx], polygon[i][next_idx]};
+            if (check_intersect(segment, seg_other)) return count_chord(false);
+            curr_idx = next_idx;
+        } while (curr_idx != 0);
+    }
+    return count_chord(true);
+}
+
+bool is_interior_chord_start_or_end(const EdgeGrid& edge_grid, const Segment& segment) {
+    return count_chord(!edge_grid.intersects(segment));
+}
+
+bool is_interior_chord_start_or_end(const EdgeBatch& edge_batch, const Segment& segment) {
+    return count_chord(!edge_batch.intersects(segment));
+}
+
+/*
+ * Edges is either the polygon itself or an EdgeGrid or EdgeBatch
+ * over it, matching an is_interior_chord_start_or_end overload
+ */
+template<typename T, typename Edges>
+bool interior_chord_vertex_vertex(const Edges& edges, const BasicVertexCone<T>& cone, const BasicPoint<T>& to) {
+    // a segment collision if the segment starts from a
+    // vertex and immediately leaves the polygon
+    if (!pointing_inside(cone, to)) return count_chord(false);
+
+    // if it is pointing inside, the remainder of the check is the same
+    return is_interior_chord_start_or_end(edges, (BasicSegment<T>) {cone.vertex, to});
+}
+
+template<typename T, typename Edges>
+void vertex_vertex_adjacency(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const Edges& edges,
+        std::vector<BasicEdge<T>>& adj_list_row,
+        const IndexPair idxp) {
+
+    BasicPoint<T> vertex = polygon[idxp.i][idxp.j];
+    BasicVertexCone<T> cone = get_vertex_cone(polygon, idxp);
+
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            if (i == idxp.i && j == idxp.j) continue;
+
+            IndexPair idxp_other = {i, j};
+            BasicPoint<T> vertex_other = polygon[idxp_other.i][idxp_other.j];
+            BasicSegment<T> segment = {vertex, vertex_other};
+
+            bool neighbors = i == idxp.i && is_neighbor_idx(j, idxp.j, polygon[i].size());
+
+            if (neighbors || interior_chord_vertex_vertex(edges, cone, vertex_other)) {
+                adj_list_row.push_back((BasicEdge<T>) {idxp_other, length(segment)});
+            }
+        }
+    }
+}
+
+template<typename T>
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        const IndexPair& from,
+        const IndexPair& to) {
+    return interior_chord_vertex_vertex(polygon, get_vertex_cone(polygon, from), polygon[to.i][to.j]);
+}
+
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeGrid& edge_grid,
+        const IndexPair& from,
+        const IndexPair& to) {
+    return interior_chord_vertex_vertex(edge_grid, get_vertex_cone(polygon, from), polygon[to.i][to.j]);
+}
+
+bool is_interior_chord_vertex_vertex(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeBatch& edge_batch,
+        const IndexPair& from,
+        const IndexPair& to) {
+    return interior_chord_vertex_vertex(edge_batch, get_vertex_cone(polygon, from), polygon[to.i][to.j]);
+}
+
+template<typename T>
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<BasicPoint<T>>>& polygon,
+        std::vector<BasicEdge<T>>& adj_list_row,
+        const IndexPair idxp) {
+    vertex_vertex_adjacency(polygon, polygon, adj_list_row, idxp);
+}
+
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeGrid& edge_grid,
+        std::vector<Edge>& adj_list_row,
+        const IndexPair idxp) {
+    vertex_vertex_adjacency(polygon, edge_grid, adj_list_row, idxp);
+}
+
+void populate_vertex_vertex_adjacency(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeBatch& edge_batch,
+        std::vector<Edge>& adj_list_row,
+        const IndexPair idxp) {
+    vertex_vertex_adjacency(polygon, edge_batch, adj_list_row, idxp);
+}
+
+// every template above, for each coordinate type of ScalarTraits
+#define INSTANTIATE_GEOMETRY(T) \
+    template bool operator==(const BasicPoint<T>&, const BasicPoint<T>&); \
+    template ScalarTraits<T>::Distance length(const BasicSegment<T>&); \
+    template Orientation orientation(const BasicPoint<T>&, const BasicPoint<T>&, const BasicPoint<T>&); \
+    template bool share_endpoint(const BasicSegment<T>&, const BasicSegment<T>&); \
+    template bool on_segment(const BasicSegment<T>&, const BasicPoint<T>&); \
+    template bool check_intersect(const BasicSegment<T>&, const BasicSegment<T>&); \
+    template BasicVertexCone<T> get_vertex_cone(const std::vector<std::vector<BasicPoint<T>>>&, const IndexPair&); \
+    template std::vector<BasicVertexCone<T>> get_vertex_cones(const std::vector<std::vector<BasicPoint<T>>>&); \
+    template bool pointing_inside(const BasicVertexCone<T>&, const BasicPoint<T>&); \
+    template bool is_reflex_vertex(const std::vector<std::vector<BasicPoint<T>>>&, const IndexPair&); \
+    template bool is_tangent(const std::vector<std::vector<BasicPoint<T>>>&, const IndexPair&, const BasicPoint<T>&); \
+    template bool is_interior_chord_start_or_end(const std::vector<std::vector<BasicPoint<T>>>&, \
+                                                 const BasicSegment<T>&); \
+    template bool is_interior_chord_vertex_vertex(const std::vector<std::vector<BasicPoint<T>>>&, const IndexPair&, \
+                                                  const IndexPair&); \
+    template void populate_vertex_vertex_adjacency(const std::vector<std::vector<BasicPoint<T>>>&, \
+                                                   std::vector<BasicEdge<T>>&, const IndexPair);
+
+INSTANTIATE_GEOMETRY(double)
+INSTANTIATE_GEOMETRY(float)
+INSTANTIATE_GEOMETRY(int32_t)
+
+#undef INSTANTIATE_GEOMETRY
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,1105 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "polygon_index.hpp"
+#include "indexed_heap.hpp"
+#include "polygon_geometry.hpp"
+#include "parallel.hpp"
+#include "triangulation_index.hpp"
+#include "visibility_sweep.hpp"
+
+namespace bfreeman {
+
+// the graph and all-pairs table of an index that built them itself
+struct BuiltGraph {
+    CompactGraph graph;
+    std::vector<double> all_pairs_distances;
+    std::vector<uint32_t> all_pairs_next;
+};
+
+// out of line, where TriangulationScratch is a complete type
+QueryContext::QueryContext() = default;
+
+QueryContext::QueryContext(QueryContext&& other) noexcept = default;
+
+QueryContext& QueryContext::operator=(QueryContext&& other) noexcept = default;
+
+QueryContext::~QueryContext() = default;
+
+PolygonIndex::PolygonIndex(
+        const std::vector<std::vector<Point>>& polygon,
+        const bool use_edge_grid,
+        const bool reduced) :
+        polygon(polygon), edge_grid(polygon), edge_batch(polygon), point_locator(polygon), use_edge_grid(use_edge_grid),
+        reduced(reduced),
+        graph((CompactGraphView) {nullptr, nullptr, nullptr, 0, 0}), all_pairs_distances(nullptr), all_pairs_next(nullptr) {
+
+    size_t node_count = 2; // start and end point
+    for (size_t i = 0; i < polygon.size(); i++) {
+        ring_offsets.push_back(node_count);
+        node_count += polygon[i].size();
+        vertices.insert(vertices.end(), polygon[i].begin(), polygon[i].end());
+    }
+    reflex.resize(vertices.size(), true);
+}
+
+PolygonIndex::PolygonIndex(
+        const std::vector<std::vector<Point>>& polygon,
+        const IndexOptions& options) :
+        PolygonIndex(polygon, options.edge_grid, options.reduced) {
+    StatsScope stats_scope(options.stats);
+    StatsTimer stats_timer(&QueryStats::build_seconds);
+
+    // a reduced graph only has edges at the vertices shortest paths can bend at
+    if (reduced) {
+        for (size_t idx = 0; idx < reflex.size(); idx++) {
+            reflex[idx] = is_reflex_vertex(polygon, get_idxp(idx + 2));
+        }
+    }
+
+    VisibilitySweep sweep(polygon, edge_grid);
+
+    // each row is written by exactly one worker
+    std::vector<std::vector<NodeEdge>> vertex_adjacency(vertices.size());
+    parallel_for(vertex_adjacency.size(), options.threads, ROW_CHUNK, [&](size_t idx) {
+        if (!reflex[idx]) return;
+        IndexPair idxp = get_idxp(idx + 2);
+        std::vector<Edge> adj_list_row;
+        if (options.engine == ROTATIONAL_SWEEP) {
+            sweep.populate_row(adj_list_row, idxp);
+        } else if (use_edge_grid) {
+            populate_vertex_vertex_adjacency(polygon, edge_grid, adj_list_row, idxp);
+        } else {
+            populate_vertex_vertex_adjacency(polygon, edge_batch, adj_list_row, idxp);
+        }
+        if (reduced) reduce_row(adj_list_row, idx + 2);
+        for (size_t k = 0; k < adj_list_row.size(); k++) {
+            vertex_adjacency[idx].push_back(
+                    (NodeEdge) {(uint32_t) get_node_idx(adj_list_row[k].idxp), adj_list_row[k].distance});
+        }
+    });
+
+    set_graph(vertex_adjacency, options.all_pairs, options.threads);
+}
+
+void PolygonIndex::set_graph(
+        std::vector<std::vector<NodeEdge>>& vertex_adjacency,
+        const bool all_pairs,
+        const size_t threads) {
+
+    // pack the rows into one CompactGraph, releasing each as it is copied
+    std::shared_ptr<BuiltGraph> built = std::make_shared<BuiltGraph>();
+    CompactGraph& built_graph = built->graph;
+    size_t node_count = get_node_count();
+    built_graph.offsets.assign(node_count + 1, 0);
+    for (size_t idx = 2; idx < node_count; idx++) {
+        built_graph.offsets[idx + 1] = built_graph.offsets[idx] + vertex_adjacency[idx - 2].size();
+    }
+    built_graph.targets.reserve(built_graph.offsets.back());
+    built_graph.weights.reserve(built_graph.offsets.back());
+    for (size_t idx = 2; idx < node_count; idx++) {
+        std::vector<NodeEdge>& adj_list_row = vertex_adjacency[idx - 2];
+        for (size_t k = 0; k < adj_list_row.size(); k++) {
+            built_graph.targets.push_back(adj_list_row[k].idx);
+            built_graph.weights.push_back(adj_list_row[k].distance);
+        }
+        std::vector<NodeEdge>().swap(adj_list_row);
+    }
+    graph = (CompactGraphView) {built_graph.offsets.data(), built_graph.targets.data(), built_graph.weights.data(),
+                                node_count, built_graph.targets.size()};
+
+    // the old table (if any) is no use to the search that builds the new one
+    all_pairs_distances = nullptr;
+    all_pairs_next = nullptr;
+    if (all_pairs) {
+        build_all_pairs(threads, built->all_pairs_distances, built->all_pairs_next);
+        all_pairs_distances = built->all_pairs_distances.data();
+        all_pairs_next = built->all_pairs_next.data();
+    }
+    storage = built;
+}
+
+PolygonIndex::ChangedRegion PolygonIndex::changed_region(const std::vector<Segment>& edges) {
+    ChangedRegion region = {{__DBL_MAX__, __DBL_MAX__}, {-__DBL_MAX__, -__DBL_MAX__}, __DBL_MAX__};
+    for (size_t k = 0; k < edges.size(); k++) {
+        region.min.x = fmin(region.min.x, fmin(edges[k].p1.x, edges[k].p2.x));
+        region.min.y = fmin(region.min.y, fmin(edges[k].p1.y, edges[k].p2.y));
+        region.max.x = fmax(region.max.x, fmax(edges[k].p1.x, edges[k].p2.x));
+        region.max.y = fmax(region.max.y, fmax(edges[k].p1.y, edges[k].p2.y));
+        region.shortest_edge = fmin(region.shortest_edge, length(edges[k]));
+    }
+    return region;
+}
+
+bool PolygonIndex::near_region(const Point& a, const Point& b, const ChangedRegion& region) {
+    // fmin and fmax are library calls, too slow for a test run on every pair of vertices
+    double min_x = std::min(a.x, b.x), max_x = std::max(a.x, b.x);
+    double min_y = std::min(a.y, b.y), max_y = std::max(a.y, b.y);
+    double gap = std::max(std::max(min_x - region.max.x, region.min.x - max_x),
+                          std::max(min_y - region.max.y, region.min.y - max_y));
+
+    // orientation's tolerance reaches as far as in EdgeGrid::intersects; the chord is at
+    // least as long as it is wide, which rules out most chords without a square root
+    double extent = std::max(max_x - min_x, max_y - min_y);
+    if (gap * std::min(extent, region.shortest_edge) >= 2 * ORIENTATION_EPSILON) return false;
+    double chord_length = length((Segment) {a, b});
+    if (!(chord_length > 0)) return true;
+    double margin = 2 * ORIENTATION_EPSILON / std::min(chord_length, region.shortest_edge);
+    if (gap >= margin) return false;
+
+    // a long chord's bounding box covers much more than the chord, so also
+    // check that the region is not wholly to one side of the line through it
+    const Point corners[4] = {region.min, {region.max.x, region.min.y}, region.max, {region.min.x, region.max.y}};
+    bool left = false, right = false;
+    for (const Point& corner : corners) {
+        double distance = ((b.x - a.x) * (corner.y - a.y) - (b.y - a.y) * (corner.x - a.x)) / chord_length;
+        left = left || distance > -margin;
+        right = right || distance < margin;
+    }
+    return left && right;
+}
+
+bool PolygonIndex::keeps_chord(const IndexPair& idxp, const VertexCone& cone, const IndexPair& idxp_other) const {
+    const Point& vertex_other = polygon[idxp_other.i][idxp_other.j];
+
+    // the same tests as populate_vertex_vertex_adjacency and reduce_row
+    bool neighbors = idxp.i == idxp_other.i && is_neighbor_idx(idxp.j, idxp_other.j, polygon[idxp.i].size());
+    if (!neighbors && !(pointing_inside(cone, vertex_other) && is_interior_chord((Segment) {cone.vertex, vertex_other}))) {
+        return false;
+    }
+    return !reduced || (reflex[get_node_idx(idxp_other) - 2] &&
+                        is_tangent(polygon, idxp, vertex_other) &&
+                        is_tangent(polygon, idxp_other, cone.vertex));
+}
+
+void PolygonIndex::update(
+        const std::vector<std::vector<Point>>& new_polygon,
+        const std::vector<uint32_t>& new_node_idx,
+        const std::vector<size_t>& dirty_nodes,
+        const std::vector<ChangedRegion>& added_regions,
+        const std::vector<ChangedRegion>& removed_regions,
+        const size_t threads) {
+
+    // the old graph is read until the new one replaces it
+    std::shared_ptr<const void> old_storage = storage;
+    CompactGraphView old_graph = graph;
+    bool all_pairs = all_pairs_distances != nullptr;
+
+    polygon = new_polygon;
+    edge_grid = EdgeGrid(polygon);
+    edge_batch = EdgeBatch(polygon);
+    point_locator = PointLocator(polygon);
+    ring_offsets.clear();
+    vertices.clear();
+    size_t node_count = 2;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        ring_offsets.push_back(node_count);
+        node_count += polygon[i].size();
+        vertices.insert(vertices.end(), polygon[i].begin(), polygon[i].end());
+    }
+    reflex.assign(vertices.size(), true);
+    if (reduced) {
+        for (size_t idx = 0; idx < reflex.size(); idx++) {
+            reflex[idx] = is_reflex_vertex(polygon, get_idxp(idx + 2));
+        }
+    }
+
+    // new vertices have no old row, so are built again along with dirty_nodes
+    std::vector<uint32_t> old_node_idx(node_count, UINT32_MAX);
+    for (size_t idx = 2; idx < new_node_idx.size(); idx++) {
+        if (new_node_idx[idx] != UINT32_MAX) old_node_idx[new_node_idx[idx]] = (uint32_t) idx;
+    }
+    std::vector<bool> dirty(vertices.size(), false);
+    std::vector<size_t> dirty_list;
+    for (size_t k = 0; k < dirty_nodes.size(); k++) dirty[dirty_nodes[k] - 2] = true;
+    for (size_t idx = 2; idx < node_count; idx++) {
+        if (old_node_idx[idx] == UINT32_MAX) dirty[idx - 2] = true;
+        if (dirty[idx - 2]) dirty_list.push_back(idx);
+    }
+
+    std::vector<std::vector<NodeEdge>> vertex_adjacency(vertices.size());
+    parallel_for(vertex_adjacency.size(), threads, ROW_CHUNK, [&](size_t row) {
+        if (!reflex[row]) return;
+        size_t idx = row + 2;
+        Point vertex = vertices[row];
+        std::vector<NodeEdge>& adj_list_row = vertex_adjacency[row];
+
+        if (dirty[row]) {
+            std::vector<Edge> built_row;
+            if (use_edge_grid) {
+                populate_vertex_vertex_adjacency(polygon, edge_grid, built_row, get_idxp(idx));
+            } else {
+                populate_vertex_vertex_adjacency(polygon, edge_batch, built_row, get_idxp(idx));
+            }
+            if (reduced) reduce_row(built_row, idx);
+            for (size_t k = 0; k < built_row.size(); k++) {
+                adj_list_row.push_back(
+                        (NodeEdge) {(uint32_t) get_node_idx(built_row[k].idxp), built_row[k].distance});
+            }
+            return;
+        }
+
+        /*
+         * Only an added edge can block an old chord, and only a removed edge can have
+         * blocked a pair that is no chord yet, so those near one are re-tested along
+         * with the pairs with a dirty vertex. Without removed edges, only the old chords
+         * and the dirty vertices need a look; otherwise every vertex does. The old row,
+         * the dirty vertices and the new row are all in node order, so are merged.
+         */
+        IndexPair idxp = get_idxp(idx);
+        VertexCone cone = get_vertex_cone(polygon, idxp);
+        size_t old_idx = old_node_idx[idx];
+        size_t k = old_graph.offsets[old_idx], k_end = old_graph.offsets[old_idx + 1];
+        size_t d = 0, scan_idx = removed_regions.empty() ? node_count : 2;
+        auto old_target = [&]() {
+            return k < k_end ? (size_t) new_node_idx[old_graph.targets[k]] : node_count;
+        };
+        while (true) {
+            // chords to removed vertices are dropped
+            while (k < k_end && new_node_idx[old_graph.targets[k]] == UINT32_MAX) k++;
+            size_t idx_other = std::min(std::min(old_target(), scan_idx),
+                                        d < dirty_list.size() ? dirty_list[d] : node_count);
+            if (idx_other == node_count) break;
+
+            bool had_chord = old_target() == idx_other;
+            double old_distance = had_chord ? old_graph.weights[k] : 0;
+            if (had_chord) k++;
+            if (d < dirty_list.size() && dirty_list[d] == idx_other) d++;
+            if (scan_idx == idx_other) scan_idx++;
+            if (idx_other == idx) continue;
+
+            const Point& vertex_other = vertices[idx_other - 2];
+            const std::vector<ChangedRegion>& regions = had_chord ? added_regions : removed_regions;
+            bool retest = dirty[idx_other - 2];
+            for (size_t r = 0; r < regions.size() && !retest; r++) {
+                retest = near_region(vertex, vertex_other, regions[r]);
+            }
+            if (!retest) {
+                if (had_chord) adj_list_row.push_back((NodeEdge) {(uint32_t) idx_other, old_distance});
+            } else if (keeps_chord(idxp, cone, get_idxp(idx_other))) {
+                adj_list_row.push_back((NodeEdge) {(uint32_t) idx_other, length((Segment) {vertex, vertex_other})});
+            }
+        }
+    });
+
+    set_graph(vertex_adjacency, all_pairs, threads);
+}
+
+bool PolygonIndex::insert_hole(const std::vector<Point>& hole, const size_t threads) {
+    if (hole.size() < 3) return false;
+
+    std::vector<std::vector<Point>> new_polygon = polygon;
+    new_polygon.push_back(hole);
+    std::vector<uint32_t> new_node_idx(get_node_count());
+    for (size_t idx = 0; idx < new_node_idx.size(); idx++) new_node_idx[idx] = (uint32_t) idx;
+
+    std::vector<Segment> edges;
+    for (size_t j = 0; j < hole.size(); j++) edges.push_back((Segment) {hole[j], hole[(j + 1) % hole.size()]});
+
+    update(new_polygon, new_node_idx, {}, {changed_region(edges)}, {}, threads);
+    return true;
+}
+
+bool PolygonIndex::remove_hole(const size_t i, const size_t threads) {
+    if (i == 0 || i >= polygon.size()) return false;
+
+    std::vector<std::vector<Point>> new_polygon = polygon;
+    new_polygon.erase(new_polygon.begin() + i);
+    size_t first = ring_offsets[i], last = ring_offsets[i] + polygon[i].size();
+    std::vector<uint32_t> new_node_idx(get_node_count());
+    for (size_t idx = 0; idx < new_node_idx.size(); idx++) {
+        if (idx < first) {
+            new_node_idx[idx] = (uint32_t) idx;
+        } else if (idx < last) {
+            new_node_idx[idx] = UINT32_MAX;
+        } else {
+            new_node_idx[idx] = (uint32_t) (idx - polygon[i].size());
+        }
+    }
+
+    std::vector<Segment> edges;
+    for (size_t j = 0; j < polygon[i].size(); j++) {
+        edges.push_back((Segment) {polygon[i][j], polygon[i][(j + 1) % polygon[i].size()]});
+    }
+
+    update(new_polygon, new_node_idx, {}, {}, {changed_region(edges)}, threads);
+    return true;
+}
+
+bool PolygonIndex::move_vertex(const IndexPair& idxp, const Point& point, const size_t threads) {
+    if (idxp.interior || idxp.i >= polygon.size() || idxp.j >= polygon[idxp.i].size()) return false;
+
+    std::vector<std::vector<Point>> new_polygon = polygon;
+    new_polygon[idxp.i][idxp.j] = point;
+    std::vector<uint32_t> new_node_idx(get_node_count());
+    for (size_t idx = 0; idx < new_node_idx.size(); idx++) new_node_idx[idx] = (uint32_t) idx;
+
+    // the corners at the vertex and both its neighbors change, and the two edges between them
+    size_t size = polygon[idxp.i].size();
+    IndexPair idxp_prev(idxp.i, (idxp.j + size - 1) % size), idxp_next(idxp.i, (idxp.j + 1) % size);
+    std::vector<size_t> dirty_nodes = {get_node_idx(idxp_prev), get_node_idx(idxp), get_node_idx(idxp_next)};
+    const Point& point_prev = polygon[idxp.i][idxp_prev.j];
+    const Point& point_next = polygon[idxp.i][idxp_next.j];
+    const Point& point_old = polygon[idxp.i][idxp.j];
+    std::vector<ChangedRegion> added_regions = {
+            changed_region({(Segment) {point_prev, point}}),
+            changed_region({(Segment) {point, point_next}})
+    };
+    std::vector<ChangedRegion> removed_regions = {
+            changed_region({(Segment) {point_prev, point_old}}),
+            changed_region({(Segment) {point_old, point_next}})
+    };
+
+    update(new_polygon, new_node_idx, dirty_nodes, added_regions, removed_regions, threads);
+    return true;
+}
+
+void PolygonIndex::build_all_pairs(
+        const size_t threads,
+        std::vector<double>& distances_table,
+        std::vector<uint32_t>& next_table) const {
+
+    size_t vertex_count = vertices.size();
+    distances_table.assign(vertex_count * vertex_count, __DBL_MAX__);
+    next_table.assign(vertex_count * vertex_count, START_IDX);
+
+    QueryEdges no_query_edges;
+    no_query_edges.sees_start.resize(vertex_count);
+    no_query_edges.sees_end.resize(vertex_count);
+    no_query_edges.start_sees_end = false;
+    no_query_edges.start_end_distance = 0;
+
+    // the graph is undirected, so the node before idx1 on the path a search from idx2
+    // finds to idx1 is the node after idx1 on a path to idx2; each search fills one row
+    parallel_for(vertex_count, threads, 1, [&](size_t row) {
+        if (!reflex[row]) return;
+        IndexedHeap point_queue;
+        std::vector<double> distances;
+        std::vector<uint32_t> prev_point_in_shortest_path;
+        search(row + 2, no_query_edges, vertices[row], vertices[row], false, nullptr, point_queue, distances,
+               prev_point_in_shortest_path);
+        std::copy(distances.begin() + 2, distances.end(), distances_table.begin() + row * vertex_count);
+        std::copy(prev_point_in_shortest_path.begin() + 2, prev_point_in_shortest_path.end(),
+                  next_table.begin() + row * vertex_count);
+    });
+}
+
+IndexFileStatus PolygonIndex::save(const std::string& path) const {
+    IndexFileHeader header;
+    memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.byte_order = INDEX_FILE_BYTE_ORDER;
+    header.version = INDEX_FILE_VERSION;
+    header.flags = (reduced ? INDEX_FILE_REDUCED : 0) | (use_edge_grid ? INDEX_FILE_EDGE_GRID : 0) |
+                   (all_pairs_distances != nullptr ? INDEX_FILE_ALL_PAIRS : 0);
+    header.ring_count = polygon.size();
+    header.vertex_count = vertices.size();
+    header.edge_count = graph.edge_count;
+    header.file_size = index_file_layout(header).file_size;
+    header.checksum = 0;
+
+    std::vector<uint64_t> ring_sizes;
+    for (size_t i = 0; i < polygon.size(); i++) ring_sizes.push_back(polygon[i].size());
+    std::vector<uint8_t> reflex_bytes(reflex.begin(), reflex.end());
+    size_t table_size = all_pairs_distances != nullptr ? vertices.size() * vertices.size() : 0;
+
+    // the sections in file order, each padded with zeros to a multiple of 8 bytes
+    const std::pair<const void*, size_t> sections[] = {
+            {ring_sizes.data(), ring_sizes.size() * sizeof(uint64_t)},
+            {vertices.data(), vertices.size() * sizeof(Point)},
+            {reflex_bytes.data(), reflex_bytes.size()},
+            {graph.offsets, (graph.node_count + 1) * sizeof(size_t)},
+            {graph.targets, graph.edge_count * sizeof(uint32_t)},
+            {graph.weights, graph.edge_count * sizeof(double)},
+            {all_pairs_distances, table_size * sizeof(double)},
+            {all_pairs_next, table_size * sizeof(uint32_t)}
+    };
+    for (const std::pair<const void*, size_t>& section : sections) {
+        header.checksum = index_file_checksum(header.checksum, section.first, section.second);
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) return INDEX_FILE_IO_ERROR;
+    const char padding[8] = {0};
+    file.write((const char*) &header, sizeof(header));
+    for (const std::pair<const void*, size_t>& section : sections) {
+        if (section.second == 0) continue;
+        file.write((const char*) section.first, (std::streamsize) section.second);
+        file.write(padding, (std::streamsize) ((8 - section.second % 8) % 8));
+    }
+    file.close();
+    return file ? INDEX_FILE_OK : INDEX_FILE_IO_ERROR;
+}
+
+IndexFileStatus PolygonIndex::load(
+        const std::string& path,
+        std::unique_ptr<PolygonIndex>& index,
+        const bool verify_checksum) {
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    if (!file->is_open()) return INDEX_FILE_IO_ERROR;
+    if (file->size() < sizeof(IndexFileHeader)) return INDEX_FILE_TRUNCATED;
+
+    const IndexFileHeader& header = *(const IndexFileHeader*) file->data();
+    if (memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.byte_order != INDEX_FILE_BYTE_ORDER) {
+        return INDEX_FILE_NOT_AN_INDEX;
+    }
+    if (header.version != INDEX_FILE_VERSION) return INDEX_FILE_BAD_VERSION;
+
+    IndexFileLayout layout = index_file_layout(header);
+    if (header.file_size != layout.file_size || file->size() < layout.file_size) return INDEX_FILE_TRUNCATED;
+    if (verify_checksum) {
+        const uint8_t* body = file->data() + sizeof(IndexFileHeader);
+        if (index_file_checksum(0, body, layout.file_size - sizeof(IndexFileHeader)) != header.checksum) {
+            return INDEX_FILE_BAD_CHECKSUM;
+        }
+    }
+
+    // the polygon is copied out, as the geometry code takes it as vectors
+    const uint64_t* ring_sizes = (const uint64_t*) (file->data() + layout.ring_sizes);
+    const Point* file_vertices = (const Point*) (file->data() + layout.vertices);
+    size_t vertex_count = 0;
+    for (size_t i = 0; i < header.ring_count; i++) vertex_count += ring_sizes[i];
+    if (vertex_count != header.vertex_count) return INDEX_FILE_NOT_AN_INDEX;
+    std::vector<std::vector<Point>> polygon(header.ring_count);
+    for (size_t i = 0, first = 0; i < polygon.size(); first += ring_sizes[i], i++) {
+        polygon[i].assign(file_vertices + first, file_vertices + first + ring_sizes[i]);
+    }
+
+    std::unique_ptr<PolygonIndex> loaded(new PolygonIndex(
+            polygon, (header.flags & INDEX_FILE_EDGE_GRID) != 0, (header.flags & INDEX_FILE_REDUCED) != 0));
+    const uint8_t* reflex_bytes = file->data() + layout.reflex;
+    loaded->reflex.assign(reflex_bytes, reflex_bytes + header.vertex_count);
+
+    loaded->graph = (CompactGraphView) {
+            (const size_t*) (file->data() + layout.offsets),
+            (const uint32_t*) (file->data() + layout.targets),
+            (const double*) (file->data() + layout.weights),
+            header.vertex_count + 2,
+            header.edge_count
+    };
+    if (header.flags & INDEX_FILE_ALL_PAIRS) {
+        loaded->all_pairs_distances = (const double*) (file->data() + layout.table_distances);
+        loaded->all_pairs_next = (const uint32_t*) (file->data() + layout.table_next);
+    }
+    loaded->storage = file;
+
+    index = std::move(loaded);
+    return INDEX_FILE_OK;
+}
+
+void PolygonIndex::reduce_row(std::vector<Edge>& adj_list_row, const size_t idx) const {
+    IndexPair idxp = get_idxp(idx);
+    Point vertex = vertices[idx - 2];
+
+    // keep the chords between reflex vertices that are tangent at both ends
+    std::vector<Edge> bitangents;
+    for (size_t k = 0; k < adj_list_row.size(); k++) {
+        const Edge& edge = adj_list_row[k];
+        Point vertex_other = polygon[edge.idxp.i][edge.idxp.j];
+        if (reflex[get_node_idx(edge.idxp) - 2] &&
+            is_tangent(polygon, idxp, vertex_other) &&
+            is_tangent(polygon, edge.idxp, vertex)) {
+            bitangents.push_back(edge);
+        }
+    }
+    adj_list_row.swap(bitangents);
+}
+
+bool PolygonIndex::is_interior_chord(const Segment& segment) const {
+    if (use_edge_grid) return is_interior_chord_start_or_end(edge_grid, segment);
+    return is_interior_chord_start_or_end(edge_batch, segment);
+}
+
+const std::vector<std::vector<Point>>& PolygonIndex::get_polygon() const {
+    return polygon;
+}
+
+PointLocation PolygonIndex::locate(const Point& point) const {
+    return point_locator.locate(point);
+}
+
+CompactGraphView PolygonIndex::get_graph() const {
+    return graph;
+}
+
+double PolygonIndex::get_vertex_distance(const size_t idx1, const size_t idx2) const {
+    if (all_pairs_distances == nullptr) return __DBL_MAX__;
+    return all_pairs_distances[(idx2 - 2) * vertices.size() + idx1 - 2];
+}
+
+size_t PolygonIndex::get_node_count() const {
+    return vertices.size() + 2;
+}
+
+size_t PolygonIndex::get_node_idx(const IndexPair& idxp) const {
+    if (idxp.interior) return idxp.i;
+    return ring_offsets[idxp.i] + idxp.j;
+}
+
+IndexPair PolygonIndex::get_idxp(const size_t idx) const {
+    if (idx == START_IDX) return START_IDXP;
+    if (idx == END_IDX) return END_IDXP;
+    // the last ring starting at or before idx contains it
+    size_t i = std::upper_bound(ring_offsets.begin(), ring_offsets.end(), idx) - ring_offsets.begin() - 1;
+    return IndexPair(i, idx - ring_offsets[i]);
+}
+
+void PolygonIndex::connect_point(
+        const Point& point,
+        std::vector<NodeEdge>& point_edges,
+        std::vector<bool>& sees_point) const {
+
+    point_edges.clear();
+    sees_point.assign(vertices.size(), false);
+    size_t adj_list_idx = 0;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            IndexPair idxp = {i, j};
+            Segment segment = {point, polygon[idxp.i][idxp.j]};
+
+            if (reflex[adj_list_idx] &&
+                (!reduced || is_tangent(polygon, idxp, point)) && is_interior_chord(segment)) {
+                point_edges.push_back((NodeEdge) {(uint32_t) adj_list_idx + 2, length(segment)});
+                sees_point[adj_list_idx] = true;
+            }
+
+            adj_list_idx++;
+        }
+    }
+}
+
+void PolygonIndex::connect(const Point& start, const Point& end, QueryEdges& query_edges) const {
+    StatsTimer stats_timer(&QueryStats::build_seconds);
+
+    Segment start_end = {start, end};
+    query_edges.start_sees_end = is_interior_chord(start_end);
+    query_edges.start_end_distance = length(start_end);
+
+    connect_point(start, query_edges.start_edges, query_edges.sees_start);
+    connect_point(end, query_edges.end_edges, query_edges.sees_end);
+}
+
+std::vector<std::vector<Edge>> PolygonIndex::adjacency_list(const Point& start, const Point& end) const {
+    QueryEdges query_edges;
+    connect(start, end, query_edges);
+    std::vector<std::vector<Edge>> adj_list(get_node_count());
+
+    if (query_edges.start_sees_end) {
+        adj_list[START_IDX].push_back((Edge) {END_IDXP, query_edges.start_end_distance});
+        adj_list[END_IDX].push_back((Edge) {START_IDXP, query_edges.start_end_distance});
+    }
+    for (size_t k = 0; k < query_edges.start_edges.size(); k++) {
+        const NodeEdge& edge = query_edges.start_edges[k];
+        adj_list[START_IDX].push_back((Edge) {get_idxp(edge.idx), edge.distance});
+    }
+    for (size_t k = 0; k < query_edges.end_edges.size(); k++) {
+        const NodeEdge& edge = query_edges.end_edges[k];
+        adj_list[END_IDX].push_back((Edge) {get_idxp(edge.idx), edge.distance});
+    }
+
+    for (size_t idx = 2; idx < adj_list.size(); idx++) {
+        Point vertex = vertices[idx - 2];
+        if (query_edges.sees_start[idx - 2]) {
+            adj_list[idx].push_back((Edge) {START_IDXP, length((Segment) {start, vertex})});
+        }
+        if (query_edges.sees_end[idx - 2]) {
+            adj_list[idx].push_back((Edge) {END_IDXP, length((Segment) {end, vertex})});
+        }
+        for (size_t k = graph.offsets[idx]; k < graph.offsets[idx + 1]; k++) {
+            adj_list[idx].push_back((Edge) {get_idxp(graph.targets[k]), graph.weights[k]});
+        }
+    }
+
+    return adj_list;
+}
+
+void PolygonIndex::search(
+        const size_t source,
+        const QueryEdges& query_edges,
+        const Point& start,
+        const Point& end,
+        const bool a_star,
+        const ObstacleSet* obstacles,
+        IndexedHeap& point_queue,
+        std::vector<double>& distances,
+        std::vector<uint32_t>& prev_point_in_shortest_path) const {
+
+    StatsTimer search_timer(&QueryStats::search_seconds);
+    if (obstacles != nullptr && obstacles->empty()) obstacles = nullptr;
+
+    size_t total_points = get_node_count();
+    point_queue.reset(total_points);
+    distances.assign(total_points, __DBL_MAX__);
+    prev_point_in_shortest_path.assign(total_points, START_IDX);
+
+    // straight-line distance to end, which never overestimates the remaining path
+    auto heuristic = [&](const size_t idx) {
+        if (!a_star || idx == END_IDX) return 0.0;
+        if (idx == START_IDX) return query_edges.start_end_distance;
+        return length((Segment) {vertices[idx - 2], end});
+    };
+
+    // set up for Dijkstra'a algorithm: distance to source = 0, other distances = inf.
+    // nodes are only queued once they are reached, as unreached nodes are never popped before end
+    distances[source] = 0;
+    point_queue.push_or_decrease(source, heuristic(source));
+    STATS_ADD(heap_pushes, 1);
+
+    auto node_point = [&](const size_t idx) {
+        if (idx == START_IDX) return start;
+        if (idx == END_IDX) return end;
+        return vertices[idx - 2];
+    };
+
+    size_t point_idx;
+    auto relax = [&](const size_t adj_idx, const double distance_between) {
+        if (point_queue.is_settled(adj_idx)) return;
+
+        if (distances[adj_idx] > distance_between + distances[point_idx]) {
+            // an edge is only tested against the obstacles once it would shorten a path
+            if (obstacles != nullptr && obstacles->blocks((Segment) {node_point(point_idx), node_point(adj_idx)})) {
+                STATS_ADD(edges_blocked, 1);
+                return;
+            }
+            distances[adj_idx] = distance_between + distances[point_idx];
+            prev_point_in_shortest_path[adj_idx] = point_idx;
+            point_queue.push_or_decrease(adj_idx, distances[adj_idx] + heuristic(adj_idx));
+            STATS_ADD(heap_pushes, 1);
+        }
+    };
+
+    // Dijkstra's algorithm (or A*), visiting edges in the order adjacency_list lists them
+    while (!point_queue.empty()) {
+
+        point_idx = point_queue.pop();
+        STATS_ADD(heap_pops, 1);
+        STATS_ADD(nodes_settled, 1);
+
+        // the distance to end is final once it is popped
+        if (point_idx == END_IDX) break;
+
+        if (point_idx == START_IDX) {
+            if (query_edges.start_sees_end) relax(END_IDX, query_edges.start_end_distance);
+            for (size_t k = 0; k < query_edges.start_edges.size(); k++) {
+                relax(query_edges.start_edges[k].idx, query_edges.start_edges[k].distance);
+            }
+            continue;
+        }
+
+        Point vertex = vertices[point_idx - 2];
+        if (query_edges.sees_start[point_idx - 2]) {
+            relax(START_IDX, length((Segment) {start, vertex}));
+        }
+        if (query_edges.sees_end[point_idx - 2]) {
+            relax(END_IDX, length((Segment) {end, vertex}));
+        }
+        for (size_t k = graph.offsets[point_idx]; k < graph.offsets[point_idx + 1]; k++) {
+            relax(graph.targets[k], graph.weights[k]);
+        }
+    }
+}
+
+void PolygonIndex::reconstruct_path(
+        const std::vector<uint32_t>& prev_point_in_shortest_path,
+        size_t backtrack_idx,
+        const Point& start,
+        const Point& end,
+        std::vector<Point>& dijkstra_path) const {
+
+    StatsTimer reconstruction_timer(&QueryStats::reconstruction_seconds);
+
+    // walk back from end and then flip the path
+    dijkstra_path.clear();
+    dijkstra_path.push_back(end);
+    while (backtrack_idx != START_IDX) {
+        dijkstra_path.push_back(vertices[backtrack_idx - 2]);
+        backtrack_idx = prev_point_in_shortest_path[backtrack_idx];
+    }
+    dijkstra_path.push_back(start);
+    std::reverse(dijkstra_path.begin(), dijkstra_path.end());
+}
+
+void PolygonIndex::table_lookup(const Point& start, const Point& end, QueryContext& context) const {
+    QueryEdges& query_edges = context.query_edges;
+    connect(start, end, query_edges);
+    StatsTimer search_timer(&QueryStats::search_seconds);
+    size_t vertex_count = vertices.size();
+
+    // the vertices after start and before end on the shortest path, start for both if start sees end
+    size_t first_idx = START_IDX, last_idx = START_IDX;
+    double distance = query_edges.start_sees_end ? query_edges.start_end_distance : __DBL_MAX__;
+    for (size_t a = 0; a < query_edges.start_edges.size(); a++) {
+        const NodeEdge& start_edge = query_edges.start_edges[a];
+        for (size_t b = 0; b < query_edges.end_edges.size(); b++) {
+            const NodeEdge& end_edge = query_edges.end_edges[b];
+            double between = all_pairs_distances[(end_edge.idx - 2) * vertex_count + start_edge.idx - 2];
+            if (between == __DBL_MAX__) continue;
+            double distance_through = start_edge.distance + between + end_edge.distance;
+            if (distance_through < distance) {
+                distance = distance_through;
+                first_idx = start_edge.idx;
+                last_idx = end_edge.idx;
+            }
+        }
+    }
+
+    search_timer.stop();
+    StatsTimer reconstruction_timer(&QueryStats::reconstruction_seconds);
+
+    std::vector<Point>& dijkstra_path = context.result.path;
+    dijkstra_path.clear();
+    dijkstra_path.push_back(start);
+    if (first_idx != START_IDX) {
+        size_t idx = first_idx;
+        dijkstra_path.push_back(vertices[idx - 2]);
+        while (idx != last_idx) {
+            idx = all_pairs_next[(last_idx - 2) * vertex_count + idx - 2];
+            dijkstra_path.push_back(vertices[idx - 2]);
+        }
+    }
+    dijkstra_path.push_back(end);
+    context.result.distance = distance;
+}
+
+DijkstraData PolygonIndex::dijkstra_path(
+        const Point& start,
+        const Point& end,
+        const QueryOptions& options) const {
+
+    QueryContext context;
+    dijkstra_path(start, end, context, options);
+    return std::move(context.result);
+}
+
+const DijkstraData& PolygonIndex::dijkstra_path(
+        const Point& start_point,
+        const Point& end_point,
+        QueryContext& context,
+        const QueryOptions& options) const {
+
+    StatsScope stats_scope(options.stats);
+    Point start = start_point, end = end_point;
+    if (options.endpoints != TRUST_ENDPOINTS) {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        if (!point_locator.resolve(start, options.endpoints) || !point_locator.resolve(end, options.endpoints)) {
+            context.result.path.clear();
+            context.result.distance = __DBL_MAX__;
+            return context.result;
+        }
+    }
+
+    bool no_obstacles = options.obstacles == nullptr || options.obstacles->empty();
+    if (options.search == TABLE_LOOKUP && all_pairs_distances != nullptr && no_obstacles) {
+        table_lookup(start, end, context);
+        return context.result;
+    }
+    connect(start, end, context.query_edges);
+
+    search(START_IDX, context.query_edges, start, end, options.search == A_STAR, options.obstacles, context.heap,
+           context.distances, context.prev);
+
+    reconstruct_path(context.prev, context.prev[END_IDX], start, end, context.result.path);
+    context.result.distance = context.distances[END_IDX];
+    return context.result;
+}
+
+GoalPath PolygonIndex::nearest_goal(
+        const Point& start,
+        const std::vector<Point>& goals,
+        const QueryOptions& options) const {
+
+    QueryContext context;
+    size_t goal = nearest_goal(start, goals, context, options);
+    return (GoalPath) {std::move(context.result), goal};
+}
+
+size_t PolygonIndex::nearest_goal(
+        const Point& start_point,
+        const std::vector<Point>& goals,
+        QueryContext& context,
+        const QueryOptions& options) const {
+
+    StatsScope stats_scope(options.stats);
+    const ObstacleSet* obstacles = options.obstacles;
+    if (obstacles != nullptr && obstacles->empty()) obstacles = nullptr;
+
+    // goal g is node goal_base + g, after start, end and the vertices
+    size_t goal_base = get_node_count();
+    size_t total_points = goal_base + goals.size();
+    Point start = start_point;
+    QueryEdges& query_edges = context.query_edges;
+    std::vector<Point>& goal_points = context.goals;
+    std::vector<uint32_t>& goal_order = context.goal_order;
+    {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        if (!point_locator.resolve(start, options.endpoints)) {
+            context.result.path.clear();
+            context.result.distance = __DBL_MAX__;
+            return NO_GOAL;
+        }
+        connect_point(start, query_edges.start_edges, query_edges.sees_start);
+
+        // rejected goals are left out of goal_order, so are never connected
+        goal_points.assign(goals.begin(), goals.end());
+        goal_order.clear();
+        for (size_t g = 0; g < goals.size(); g++) {
+            if (point_locator.resolve(goal_points[g], options.endpoints)) goal_order.push_back((uint32_t) g);
+        }
+        std::sort(goal_order.begin(), goal_order.end(), [&](const uint32_t g1, const uint32_t g2) {
+            return length((Segment) {start, goal_points[g1]}) < length((Segment) {start, goal_points[g2]});
+        });
+        context.goal_edges.clear();
+        context.goal_edge_next.clear();
+        context.goal_edge_head.assign(goal_base, UINT32_MAX);
+    }
+
+    StatsTimer search_timer(&QueryStats::search_seconds);
+    IndexedHeap& point_queue = context.heap;
+    std::vector<double>& distances = context.distances;
+    std::vector<uint32_t>& prev_point_in_shortest_path = context.prev;
+    point_queue.reset(total_points);
+    distances.assign(total_points, __DBL_MAX__);
+    prev_point_in_shortest_path.assign(total_points, START_IDX);
+
+    distances[START_IDX] = 0;
+    point_queue.push_or_decrease(START_IDX, 0);
+    STATS_ADD(heap_pushes, 1);
+
+    auto node_point = [&](const size_t idx) {
+        if (idx == START_IDX) return start;
+        if (idx >= goal_base) return goal_points[idx - goal_base];
+        return vertices[idx - 2];
+    };
+
+    auto relax = [&](const size_t from_idx, const size_t adj_idx, const double distance_between) {
+        if (point_queue.is_settled(adj_idx)) return;
+
+        if (distances[adj_idx] > distance_between + distances[from_idx]) {
+            if (obstacles != nullptr && obstacles->blocks((Segment) {node_point(from_idx), node_point(adj_idx)})) {
+                STATS_ADD(edges_blocked, 1);
+                return;
+            }
+            distances[adj_idx] = distance_between + distances[from_idx];
+            prev_point_in_shortest_path[adj_idx] = from_idx;
+            point_queue.push_or_decrease(adj_idx, distances[adj_idx]);
+            STATS_ADD(heap_pushes, 1);
+        }
+    };
+
+    /*
+     * relaxes the edges into goal g from the nodes already settled,
+     * and keeps the rest for when theirs are (counted as search
+     * time, as it runs in between the steps of the search)
+     */
+    auto connect_goal = [&](const uint32_t g) {
+        auto add_edge = [&](const size_t idx, const double distance) {
+            if (point_queue.is_settled(idx)) {
+                relax(idx, goal_base + g, distance);
+                return;
+            }
+            context.goal_edge_next.push_back(context.goal_edge_head[idx]);
+            context.goal_edge_head[idx] = (uint32_t) context.goal_edges.size();
+            context.goal_edges.push_back((NodeEdge) {(uint32_t) (goal_base + g), distance});
+        };
+
+        Segment start_goal = {start, goal_points[g]};
+        if (is_interior_chord(start_goal)) add_edge(START_IDX, length(start_goal));
+        connect_point(goal_points[g], query_edges.end_edges, query_edges.sees_end);
+        for (size_t k = 0; k < query_edges.end_edges.size(); k++) {
+            add_edge(query_edges.end_edges[k].idx, query_edges.end_edges[k].distance);
+        }
+    };
+
+    /*
+     * Dijkstra's algorithm over start, the vertices and the goals,
+     * stopping at the first goal settled. Before each node is
+     * settled, every goal whose straight-line distance from start
+     * is at most that node's is connected, so a goal is always
+     * connected before the search passes its distance.
+     */
+    size_t next_goal = 0;
+    size_t nearest = NO_GOAL;
+    while (true) {
+        double key = point_queue.empty() ? __DBL_MAX__ : point_queue.top_key();
+        while (next_goal < goal_order.size() &&
+               length((Segment) {start, goal_points[goal_order[next_goal]]}) <= key) {
+            connect_goal(goal_order[next_goal++]);
+        }
+        if (point_queue.empty()) break;
+
+        size_t point_idx = point_queue.pop();
+        STATS_ADD(heap_pops, 1);
+        STATS_ADD(nodes_settled, 1);
+
+        if (point_idx >= goal_base) {
+            nearest = point_idx - goal_base;
+            break;
+        }
+
+        for (uint32_t k = context.goal_edge_head[point_idx]; k != UINT32_MAX; k = context.goal_edge_next[k]) {
+            relax(point_idx, context.goal_edges[k].idx, context.goal_edges[k].distance);
+        }
+
+        if (point_idx == START_IDX) {
+            for (size_t k = 0; k < query_edges.start_edges.size(); k++) {
+                relax(START_IDX, query_edges.start_edges[k].idx, query_edges.start_edges[k].distance);
+            }
+            continue;
+        }
+
+        if (query_edges.sees_start[point_idx - 2]) {
+            relax(point_idx, START_IDX, length((Segment) {start, vertices[point_idx - 2]}));
+        }
+        for (size_t k = graph.offsets[point_idx]; k < graph.offsets[point_idx + 1]; k++) {
+            relax(point_idx, graph.targets[k], graph.weights[k]);
+        }
+    }
+
+    if (nearest == NO_GOAL) {
+        context.result.path.clear();
+        context.result.distance = __DBL_MAX__;
+        return NO_GOAL;
+    }
+    size_t goal_idx = goal_base + nearest;
+    reconstruct_path(prev_point_in_shortest_path, prev_point_in_shortest_path[goal_idx], start, goal_points[nearest],
+                     context.result.path);
+    context.result.distance = distances[goal_idx];
+    return nearest;
+}
+
+ShortestPathTree PolygonIndex::shortest_path_tree(const Point& start, const QueryOptions& options) const {
+    StatsScope stats_scope(options.stats);
+
+    ShortestPathTree tree;
+    tree.start = start;
+
+    // with no edges to end, the search only stops once every reachable node is settled
+    QueryEdges query_edges;
+    {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        if (!point_locator.resolve(tree.start, options.endpoints)) {
+            tree.distances.assign(get_node_count(), __DBL_MAX__);
+            tree.prev.assign(get_node_count(), START_IDX);
+            return tree;
+        }
+        query_edges.start_sees_end = false;
+        query_edges.start_end_distance = 0;
+        connect_point(tree.start, query_edges.start_edges, query_edges.sees_start);
+        query_edges.sees_end.resize(vertices.size());
+    }
+
+    IndexedHeap point_queue;
+    search(START_IDX, query_edges, tree.start, tree.start, false, options.obstacles, point_queue, tree.distances,
+           tree.prev);
+    return tree;
+}
+
+DijkstraData PolygonIndex::tree_path(
+        const ShortestPathTree& tree,
+        const Point& end,
+        const QueryOptions& options) const {
+
+    QueryContext context;
+    tree_path(tree, end, context, options);
+    return std::move(context.result);
+}
+
+const DijkstraData& PolygonIndex::tree_path(
+        const ShortestPathTree& tree,
+        const Point& end_point,
+        QueryContext& context,
+        const QueryOptions& options) const {
+
+    StatsScope stats_scope(options.stats);
+    Point end = end_point;
+    if (options.endpoints != TRUST_ENDPOINTS) {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        // a tree whose start was rejected kept it as it was, so it is still not inside
+        if (point_locator.locate(tree.start).point_class != POINT_INSIDE ||
+            !point_locator.resolve(end, options.endpoints)) {
+            context.result.path.clear();
+            context.result.distance = __DBL_MAX__;
+            return context.result;
+        }
+    }
+
+    // the vertex (or start) end is reached from, which a search to end would settle first
+    size_t before_end = START_IDX;
+    double distance = __DBL_MAX__;
+    {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        const ObstacleSet* obstacles = options.obstacles;
+        if (obstacles != nullptr && obstacles->empty()) obstacles = nullptr;
+
+        Segment start_end = {tree.start, end};
+        if (is_interior_chord(start_end) && (obstacles == nullptr || !obstacles->blocks(start_end))) {
+            distance = length(start_end);
+        }
+
+        std::vector<NodeEdge>& end_edges = context.query_edges.end_edges;
+        connect_point(end, end_edges, context.query_edges.sees_end);
+        for (size_t k = 0; k < end_edges.size(); k++) {
+            size_t idx = end_edges[k].idx;
+            if (tree.distances[idx] == __DBL_MAX__) continue;
+            if (obstacles != nullptr && obstacles->blocks((Segment) {vertices[idx - 2], end})) {
+                STATS_ADD(edges_blocked, 1);
+                continue;
+            }
+            double distance_through = end_edges[k].distance + tree.distances[idx];
+            bool settled_earlier = tree.distances[idx] < tree.distances[before_end] ||
+                                   (tree.distances[idx] == tree.distances[before_end] && idx < before_end);
+            if (distance_through < distance || (distance_through == distance && settled_earlier)) {
+                distance = distance_through;
+                before_end = idx;
+            }
+        }
+    }
+
+    reconstruct_path(tree.prev, before_end, tree.start, end, context.result.path);
+    context.result.distance = distance;
+    return context.result;
+}
+
+std::vector<DijkstraData> PolygonIndex::tree_paths(
+        const ShortestPathTree& tree,
+        const std::vector<Point>& ends,
+        const size_t threads,
+        const QueryOptions& options) const {
+
+    // the workers count into stats of their own, added to options.stats once they are done
+    StatsScope stats_scope(options.stats);
+    QueryOptions worker_options = options;
+    worker_options.stats = nullptr;
+
+    std::vector<DijkstraData> results(ends.size());
+    // one context per worker, reused for every query it runs
+    std::vector<QueryContext> contexts(worker_count(threads));
+    parallel_for(ends.size(), threads, 1, [&](size_t worker, size_t idx) {
+        results[idx] = tree_path(tree, ends[idx], contexts[worker], worker_options);
+    });
+    return results;
+}
+
+std::vector<DijkstraData> PolygonIndex::dijkstra_paths(
+        const std::vector<std::pair<Point, Point>>& queries,
+        const size_t threads,
+        const QueryOptions& options) const {
+
+    // the workers count into stats of their own, added to options.stats once they are done
+    StatsScope stats_scope(options.stats);
+    QueryOptions worker_options = options;
+    worker_options.stats = nullptr;
+
+    std::vector<DijkstraData> results(queries.size());
+    // each query writes only its own slot, so no locking is needed;
+    // one context per worker, reused for every query it runs
+    std::vector<QueryContext> contexts(worker_count(threads));
+    parallel_for(queries.size(), threads, 1, [&](size_t worker, size_t idx) {
+        results[idx] = dijkstra_path(queries[idx].first, queries[idx].second, contexts[worker], worker_options);
+    });
+    return results;
+}
+
+} // namespace bfreeman
\ No newline at end of file
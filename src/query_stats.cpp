@@ -0,0 +1,48 @@
+#include <chrono>
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+void operator+=(QueryStats& stats, const QueryStats& other) {
+    stats.check_intersect_calls += other.check_intersect_calls;
+    stats.chords_accepted += other.chords_accepted;
+    stats.chords_rejected += other.chords_rejected;
+    stats.edges_blocked += other.edges_blocked;
+    stats.heap_pushes += other.heap_pushes;
+    stats.heap_pops += other.heap_pops;
+    stats.nodes_settled += other.nodes_settled;
+    stats.build_seconds += other.build_seconds;
+    stats.search_seconds += other.search_seconds;
+    stats.reconstruction_seconds += other.reconstruction_seconds;
+}
+
+thread_local QueryStats* thread_stats = nullptr;
+
+#ifdef DIJKSTRA_POLYGON_STATS
+
+double seconds_now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+StatsScope::StatsScope(QueryStats* stats) : previous(thread_stats) {
+    if (stats) thread_stats = stats;
+}
+
+StatsScope::~StatsScope() {
+    thread_stats = previous;
+}
+
+StatsTimer::StatsTimer(double QueryStats::* seconds) : seconds(seconds), start(seconds_now()), stopped(false) {}
+
+StatsTimer::~StatsTimer() {
+    stop();
+}
+
+void StatsTimer::stop() {
+    if (!stopped && thread_stats) thread_stats->*seconds += seconds_now() - start;
+    stopped = true;
+}
+
+#endif // #ifdef DIJKSTRA_POLYGON_STATS
+
+} // namespace bfreeman
\ No newline at end of file
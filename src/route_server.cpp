@@ -0,0 +1,148 @@
+#include <charconv>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "dijkstra_polygon.hpp"
+#include "index_file.hpp"
+#include "polygon_index.hpp"
+#include "route_stream.hpp"
+#include "triangulation_index.hpp"
+
+const char* USAGE =
+        "usage: route_server [--binary] [--threads N] [--batch N] [--a-star] [--reject | --snap] [--triangulation]\n"
+        "                    POLYGON\n"
+        "\n"
+        "Loads POLYGON once, then answers the queries read from stdin on stdout\n"
+        "(see StreamFormat in route_stream.hpp for both formats).\n"
+        "\n"
+        "POLYGON is either an index written by PolygonIndex::save, which is mapped\n"
+        "in without building anything, or a text file with one ring per line as\n"
+        "x y pairs: the boundary first, then each hole.\n"
+        "\n"
+        "  --binary         read and write binary queries instead of lines of text\n"
+        "  --threads N      answer with N worker threads (default: one per hardware thread)\n"
+        "  --batch N        hand a worker at most N queries at once (default: 256)\n"
+        "  --a-star         search with A* instead of Dijkstra's algorithm\n"
+        "  --reject         answer queries with a start or end outside the polygon with no points\n"
+        "  --snap           move such a start or end to the nearest point inside first\n"
+        "  --triangulation  answer through a TriangulationIndex instead of a PolygonIndex\n";
+
+/*
+ * Reads a text polygon with one ring per line, as x y pairs
+ * separated by spaces, tabs or commas. Empty lines and lines
+ * starting with // are skipped.
+ *
+ * @return false if the file could not be read or a line is not
+ *         an even count of numbers
+ */
+bool read_polygon(const std::string& path, std::vector<std::vector<bfreeman::Point>>& polygon) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    auto is_separator = [](char c) { return c == ' ' || c == '\t' || c == ',' || c == '\r'; };
+    std::string line;
+    while (std::getline(file, line)) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+        while (p < end && is_separator(*p)) p++;
+        if (p == end || line.compare(p - line.data(), 2, "//") == 0) continue;
+
+        std::vector<double> numbers;
+        while (p < end) {
+            double number;
+            std::from_chars_result result = std::from_chars(p, end, number);
+            if (result.ec != std::errc()) return false;
+            numbers.push_back(number);
+            p = result.ptr;
+            while (p < end && is_separator(*p)) p++;
+        }
+        if (numbers.size() % 2 != 0) return false;
+
+        polygon.emplace_back();
+        for (size_t k = 0; k < numbers.size(); k += 2) {
+            polygon.back().push_back((bfreeman::Point) {numbers[k], numbers[k + 1]});
+        }
+    }
+    return !polygon.empty();
+}
+
+int main(int argc, char** argv) {
+    bfreeman::StreamOptions options;
+    bool triangulation = false;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--binary") == 0) {
+            options.format = bfreeman::BINARY_STREAM;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            options.batch_size = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--a-star") == 0) {
+            options.query.search = bfreeman::A_STAR;
+        } else if (std::strcmp(argv[i], "--reject") == 0) {
+            options.query.endpoints = bfreeman::REJECT_ENDPOINTS;
+        } else if (std::strcmp(argv[i], "--snap") == 0) {
+            options.query.endpoints = bfreeman::SNAP_ENDPOINTS;
+        } else if (std::strcmp(argv[i], "--triangulation") == 0) {
+            triangulation = true;
+        } else if (argv[i][0] != '-' && path.empty()) {
+            path = argv[i];
+        } else {
+            std::cerr << USAGE;
+            return 2;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << USAGE;
+        return 2;
+    }
+
+    // a reader that goes away shows up as a failed write instead of killing the server
+    signal(SIGPIPE, SIG_IGN);
+
+    // an index file starts with INDEX_FILE_MAGIC, which no text polygon does
+    char magic[sizeof(bfreeman::INDEX_FILE_MAGIC)] = {};
+    std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+    bool is_index = std::memcmp(magic, bfreeman::INDEX_FILE_MAGIC, sizeof(magic)) == 0;
+
+    std::unique_ptr<bfreeman::PolygonIndex> index;
+    std::vector<std::vector<bfreeman::Point>> polygon;
+    if (is_index) {
+        bfreeman::IndexFileStatus status = bfreeman::PolygonIndex::load(path, index);
+        if (status != bfreeman::INDEX_FILE_OK) {
+            std::cerr << "route_server: could not load the index " << path << " (status " << status << ")"
+                      << std::endl;
+            return 1;
+        }
+        if (triangulation) polygon = index->get_polygon();
+    } else if (!read_polygon(path, polygon)) {
+        std::cerr << "route_server: could not read a polygon from " << path << std::endl;
+        return 1;
+    }
+
+    bfreeman::StreamStatus stream_status;
+    if (triangulation) {
+        bfreeman::TriangulationIndex triangulation_index(polygon);
+        stream_status = bfreeman::route_stream(triangulation_index, STDIN_FILENO, STDOUT_FILENO, options);
+    } else {
+        if (index == nullptr) {
+            bfreeman::IndexOptions index_options;
+            index_options.threads = options.threads;
+            index = std::make_unique<bfreeman::PolygonIndex>(polygon, index_options);
+        }
+        stream_status = bfreeman::route_stream(*index, STDIN_FILENO, STDOUT_FILENO, options);
+    }
+
+    if (stream_status == bfreeman::STREAM_READ_ERROR) {
+        std::cerr << "route_server: could not read the queries" << std::endl;
+    } else if (stream_status == bfreeman::STREAM_WRITE_ERROR) {
+        std::cerr << "route_server: could not write the answers" << std::endl;
+    }
+    return stream_status == bfreeman::STREAM_OK ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "route_stream.hpp"
+#include "parallel.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+// bytes asked for by each read of in_fd
+const size_t STREAM_READ_SIZE = 1 << 16;
+
+// batches read ahead of the writer per worker
+const size_t BATCHES_PER_WORKER = 4;
+
+// the bytes of a binary query
+const size_t BINARY_QUERY_SIZE = 4 * sizeof(double);
+
+// queries read together, answered by one worker and written in one piece
+struct StreamBatch {
+    size_t sequence = 0;
+    std::vector<std::pair<Point, Point>> queries;
+
+    // false for the text lines that are not four numbers
+    std::vector<bool> parsed;
+
+    std::string output;
+};
+
+/*
+ * Hands batches from the reader to the workers, and from the
+ * workers to the writer in the order they were read
+ */
+class StreamPipeline {
+public:
+    explicit StreamPipeline(const size_t max_in_flight) : max_in_flight(max_in_flight) {}
+
+    /*
+     * Waits while max_in_flight batches are read but not yet written
+     *
+     * @return false if the writer has failed, so reading should stop
+     */
+    bool push_input(StreamBatch&& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        room.wait(lock, [&]() { return in_flight < max_in_flight || failed; });
+        if (failed) return false;
+        batch.sequence = read_count++;
+        in_flight++;
+        input.push_back(std::move(batch));
+        input_ready.notify_one();
+        return true;
+    }
+
+    void close_input() {
+        std::lock_guard<std::mutex> lock(mutex);
+        input_closed = true;
+        input_ready.notify_all();
+        output_ready.notify_all();
+    }
+
+    // @return false once the input is closed and every batch has been taken
+    bool pop_input(StreamBatch& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        input_ready.wait(lock, [&]() { return !input.empty() || input_closed; });
+        if (input.empty()) return false;
+        batch = std::move(input.front());
+        input.pop_front();
+        return true;
+    }
+
+    void push_output(StreamBatch&& batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t sequence = batch.sequence;
+        output.emplace(sequence, std::move(batch));
+        if (sequence == written_count) output_ready.notify_one();
+    }
+
+    // @return false once every batch read has been taken, otherwise the next one in order
+    bool pop_output(StreamBatch& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        output_ready.wait(lock, [&]() {
+            return (!output.empty() && output.begin()->first == written_count) ||
+                   (input_closed && written_count == read_count);
+        });
+        if (output.empty() || output.begin()->first != written_count) return false;
+        batch = std::move(output.begin()->second);
+        output.erase(output.begin());
+        written_count++;
+        in_flight--;
+        room.notify_one();
+        return true;
+    }
+
+    // stops the reader; the batches in flight are still answered, but not written
+    void fail() {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = true;
+        room.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable input_ready;
+    std::condition_variable output_ready;
+    std::condition_variable room;
+
+    std::deque<StreamBatch> input;
+    std::map<size_t, StreamBatch> output;
+
+    size_t max_in_flight;
+    size_t in_flight = 0;
+    size_t read_count = 0;
+    size_t written_count = 0;
+    bool input_closed = false;
+    bool failed = false;
+};
+
+// @return the first character from p on that is not a space, tab or comma
+const char* skip_separators(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) p++;
+    return p;
+}
+
+// @return true if [begin, end) is exactly four numbers, which are read into query
+bool parse_query(const char* begin, const char* end, std::pair<Point, Point>& query) {
+    double* values[4] = {&query.first.x, &query.first.y, &query.second.x, &query.second.y};
+    const char* p = begin;
+    for (size_t k = 0; k < 4; k++) {
+        p = skip_separators(p, end);
+        // from_chars takes no leading '+'
+        if (p < end && *p == '+') p++;
+        std::from_chars_result result = std::from_chars(p, end, *values[k]);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+    }
+    return skip_separators(p, end) == end;
+}
+
+void append_number(std::string& output, const double number) {
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    output.append(buffer, result.ptr);
+}
+
+void append_bytes(std::string& output, const void* data, const size_t size) {
+    output.append((const char*) data, size);
+}
+
+/*
+ * Reads in_fd to its end, passing the queries to pipeline in
+ * batches, each cut short when a read comes back short
+ *
+ * @return false if a read failed or binary input ended partway through a query
+ */
+bool read_queries(const int in_fd, const StreamOptions& options, StreamPipeline& pipeline) {
+    size_t batch_size = options.batch_size > 0 ? options.batch_size : 1;
+    StreamBatch batch;
+    bool writing = true;
+    auto flush = [&]() {
+        if (batch.queries.empty()) return;
+        writing = pipeline.push_input(std::move(batch));
+        batch = StreamBatch();
+    };
+    auto add_query = [&](const std::pair<Point, Point>& query, const bool parsed) {
+        batch.queries.push_back(query);
+        batch.parsed.push_back(parsed);
+        if (batch.queries.size() == batch_size) flush();
+    };
+    auto add_line = [&](const char* begin, const char* end) {
+        if (end > begin && end[-1] == '\r') end--;
+        begin = skip_separators(begin, end);
+        if (begin == end || (end - begin >= 2 && begin[0] == '/' && begin[1] == '/')) return;
+        std::pair<Point, Point> query = {{0, 0}, {0, 0}};
+        add_query(query, parse_query(begin, end, query));
+    };
+
+    // the start of a line or binary query cut off by the end of the last read
+    std::string pending;
+    std::vector<char> buffer(STREAM_READ_SIZE);
+    while (writing) {
+        ssize_t count = read(in_fd, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) return false;
+        if (count == 0) break;
+
+        const char* p = buffer.data();
+        const char* end = p + count;
+        if (options.format == BINARY_STREAM) {
+            if (!pending.empty()) {
+                size_t missing = std::min(BINARY_QUERY_SIZE - pending.size(), (size_t) (end - p));
+                pending.append(p, missing);
+                p += missing;
+                if (pending.size() == BINARY_QUERY_SIZE) {
+                    double values[4];
+                    memcpy(values, pending.data(), BINARY_QUERY_SIZE);
+                    add_query({{values[0], values[1]}, {values[2], values[3]}}, true);
+                    pending.clear();
+                }
+            }
+            for (; (size_t) (end - p) >= BINARY_QUERY_SIZE; p += BINARY_QUERY_SIZE) {
+                double values[4];
+                memcpy(values, p, BINARY_QUERY_SIZE);
+                add_query({{values[0], values[1]}, {values[2], values[3]}}, true);
+            }
+            pending.append(p, end);
+        } else {
+            const char* newline;
+            while ((newline = (const char*) memchr(p, '\n', end - p)) != nullptr) {
+                if (pending.empty()) {
+                    add_line(p, newline);
+                } else {
+                    pending.append(p, newline);
+                    add_line(pending.data(), pending.data() + pending.size());
+                    pending.clear();
+                }
+                p = newline + 1;
+            }
+            pending.append(p, end);
+        }
+        if ((size_t) count < buffer.size()) flush();
+    }
+
+    // a last line without a newline is still a query, but a partial binary query is not
+    if (options.format == TEXT_STREAM && !pending.empty()) {
+        add_line(pending.data(), pending.data() + pending.size());
+        pending.clear();
+    }
+    flush();
+    return pending.empty();
+}
+
+// answers the queries of batch into batch.output
+template<typename Index>
+void answer_batch(const Index& index, const StreamOptions& options, QueryContext& context, StreamBatch& batch) {
+    batch.output.clear();
+    for (size_t k = 0; k < batch.queries.size(); k++) {
+        if (!batch.parsed[k]) {
+            batch.output.append("error\n");
+            continue;
+        }
+        const DijkstraData& dijkstra_data =
+                index.dijkstra_path(batch.queries[k].first, batch.queries[k].second, context, options.query);
+        const std::vector<Point>& path = dijkstra_data.path;
+
+        if (options.format == BINARY_STREAM) {
+            uint64_t count = path.size();
+            append_bytes(batch.output, &dijkstra_data.distance, sizeof(double));
+            append_bytes(batch.output, &count, sizeof(uint64_t));
+            append_bytes(batch.output, path.data(), path.size() * sizeof(Point));
+        } else {
+            append_number(batch.output, dijkstra_data.distance);
+            batch.output.push_back(' ');
+            batch.output.append(std::to_string(path.size()));
+            for (size_t i = 0; i < path.size(); i++) {
+                batch.output.push_back(' ');
+                append_number(batch.output, path[i].x);
+                batch.output.push_back(' ');
+                append_number(batch.output, path[i].y);
+            }
+            batch.output.push_back('\n');
+        }
+    }
+}
+
+// @return false if writing all of data to out_fd failed
+bool write_all(const int out_fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t count = write(out_fd, data.data() + written, data.size() - written);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        written += (size_t) count;
+    }
+    return true;
+}
+
+template<typename Index>
+StreamStatus run_stream(const Index& index, const int in_fd, const int out_fd, const StreamOptions& options) {
+    size_t workers = worker_count(options.threads);
+    StreamPipeline pipeline(BATCHES_PER_WORKER * workers);
+
+    // each worker counts into its own stats, added to the caller's once all are joined
+    QueryStats* caller_stats = options.query.stats ? options.query.stats : current_stats();
+    std::vector<QueryStats> worker_stats(caller_stats ? workers : 0);
+    StreamOptions worker_options = options;
+    worker_options.query.stats = nullptr;
+
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < workers; i++) {
+        pool.emplace_back([&, i]() {
+            StatsScope stats_scope(caller_stats ? &worker_stats[i] : nullptr);
+            QueryContext context;
+            StreamBatch batch;
+            while (pipeline.pop_input(batch)) {
+                answer_batch(index, worker_options, context, batch);
+                pipeline.push_output(std::move(batch));
+            }
+        });
+    }
+
+    bool write_failed = false;
+    std::thread writer([&]() {
+        StreamBatch batch;
+        while (pipeline.pop_output(batch)) {
+            // after a failed write the rest of the answers are dropped, so the workers can finish
+            if (!write_failed && !write_all(out_fd, batch.output)) {
+                write_failed = true;
+                pipeline.fail();
+            }
+        }
+    });
+
+    bool read_ok = read_queries(in_fd, options, pipeline);
+    pipeline.close_input();
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    writer.join();
+    for (size_t i = 0; i < worker_stats.size(); i++) {
+        *caller_stats += worker_stats[i];
+    }
+
+    if (write_failed) return STREAM_WRITE_ERROR;
+    return read_ok ? STREAM_OK : STREAM_READ_ERROR;
+}
+
+StreamStatus route_stream(
+        const PolygonIndex& index,
+        const int in_fd,
+        const int out_fd,
+        const StreamOptions& options) {
+
+    return run_stream(index, in_fd, out_fd, options);
+}
+
+StreamStatus route_stream(
+        const TriangulationIndex& index,
+        const int in_fd,
+        const int out_fd,
+        const StreamOptions& options) {
+
+    return run_stream(index, in_fd, out_fd, options);
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include "test_data_reader.hpp"
 #include "test_util.hpp"
+#include "index_file.hpp"
 #include <iostream>
 
 const std::string TEST_FOLDER = "tests";
@@ -225,4 +229,138 @@ void* read_test_data(const ReadType type, const std::string& name, const size_t
         case PATH_POINTS:
             return (void*) path_points;
     }
+}
+
+std::string test_data_path(const std::string& name) {
+    return "./" + TEST_FOLDER + "/" + name;
+}
+
+// spaces and tabs (and the \r of a \r\n line ending) around the fields of a line
+const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+// moves p past the blanks after a field and the comma after them, false if anything else follows
+bool end_field(const char*& p, const char* end) {
+    p = skip_blanks(p, end);
+    if (p == end) return true;
+    if (*p != ',') return false;
+    p++;
+    return true;
+}
+
+// reads the next field of a line into value, in place
+template<typename T>
+bool read_field(const char*& p, const char* end, T& value) {
+    p = skip_blanks(p, end);
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return end_field(p, end);
+}
+
+bool read_field(const char*& p, const char* end, bool& value) {
+    p = skip_blanks(p, end);
+    if (end - p >= 4 && memcmp(p, "true", 4) == 0) {
+        value = true;
+        p += 4;
+    } else if (end - p >= 5 && memcmp(p, "false", 5) == 0) {
+        value = false;
+        p += 5;
+    } else {
+        return false;
+    }
+    return end_field(p, end);
+}
+
+// @return true if token is the delimiter of a section, which is then set to its ReadType
+bool read_delimiter(const char* begin, const char* end, ReadType& section) {
+    const ReadType types[] = {SHAPE, START_END, ADJACENCY_LIST, PATH_LENGTH, PATH_POINTS};
+    for (const ReadType type : types) {
+        const std::string delimiter = get_file_delimiter(type);
+        if ((size_t) (end - begin) == delimiter.size() && memcmp(begin, delimiter.data(), delimiter.size()) == 0) {
+            section = type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// reads one line of the given section, from p to end, into data
+bool read_line(const ReadType section, const char* p, const char* end, TestData& data) {
+    size_t idx, i, j;
+    bool interior;
+    double x, y, x2, y2, distance;
+    switch (section) {
+        case SHAPE:
+            // rings may only start in order, so a bad index cannot allocate much
+            if (!read_field(p, end, idx) || idx > data.polygon.size() ||
+                !read_field(p, end, x) || !read_field(p, end, y)) {
+                return false;
+            }
+            if (idx == data.polygon.size()) data.polygon.emplace_back();
+            push_point(data.polygon[idx], x, y);
+            break;
+        case START_END:
+            if (!read_field(p, end, x) || !read_field(p, end, y) ||
+                !read_field(p, end, x2) || !read_field(p, end, y2)) {
+                return false;
+            }
+            data.start_end = {{x, y}, {x2, y2}};
+            break;
+        case ADJACENCY_LIST:
+            if (!read_field(p, end, idx) || idx > data.adjacency_list.size() ||
+                !read_field(p, end, i) || !read_field(p, end, j) ||
+                !read_field(p, end, interior) || !read_field(p, end, distance)) {
+                return false;
+            }
+            if (idx == data.adjacency_list.size()) data.adjacency_list.emplace_back();
+            push_edge(data.adjacency_list[idx], i, j, interior, distance);
+            break;
+        case PATH_LENGTH:
+            if (!read_field(p, end, data.path_length)) return false;
+            break;
+        case PATH_POINTS:
+            if (!read_field(p, end, x) || !read_field(p, end, y)) return false;
+            push_point(data.path_points, x, y);
+            break;
+    }
+    return p == end;
+}
+
+TestDataStatus load_test_data(const std::string& path, TestData& data, size_t* bad_line) {
+    bfreeman::MappedFile file(path);
+    if (!file.is_open()) return TEST_DATA_IO_ERROR;
+
+    data = TestData();
+    data.path_length = 0;
+    const char* p = (const char*) file.data();
+    const char* file_end = p + file.size();
+    ReadType section = SHAPE;
+    bool in_section = false;
+    for (size_t line_number = 1; p < file_end; line_number++) {
+        const char* line_end = (const char*) memchr(p, '\n', file_end - p);
+        if (line_end == nullptr) line_end = file_end;
+        const char* begin = skip_blanks(p, line_end);
+        const char* end = line_end;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+        p = line_end + 1;
+
+        // skip empty lines and comments
+        if (begin == end || (end - begin >= 2 && begin[0] == '/' && begin[1] == '/')) continue;
+
+        bool line_read;
+        if (*begin == '#') {
+            line_read = read_delimiter(begin, end, section);
+            in_section = in_section || line_read;
+        } else {
+            line_read = in_section && read_line(section, begin, end, data);
+        }
+        if (!line_read) {
+            if (bad_line != nullptr) *bad_line = line_number;
+            return TEST_DATA_BAD_LINE;
+        }
+    }
+    return TEST_DATA_OK;
 }
\ No newline at end of file
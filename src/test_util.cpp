@@ -152,6 +152,71 @@ void run_test(
     }
 }
 
+void run_path_test(
+        std::string name,
+        const Polygon& polygon,
+        const double test_path_length,
+        const double true_path_length,
+        const std::vector<bfreeman::Point>& test_path_points,
+        const std::vector<bfreeman::Point>& true_path_points,
+        unsigned short& passed_tests,
+        const bool verbose) {
+
+    bool passed = is_close(test_path_length, true_path_length)
+                  && compare_path(test_path_points, true_path_points);
+    if (verbose || !passed) {
+        print_label(name);
+        print_polygon(polygon);
+        print_path_lengths(test_path_length, true_path_length);
+        print_path_points(test_path_points, true_path_points);
+        print_seperation_line();
+    }
+    if (passed) {
+        std::cout << "PASSED " << name << std::endl;
+        passed_tests++;
+    } else {
+        std::cout << "FAILED " << name << std::endl;
+    }
+}
+
+void run_length_test(
+        std::string name,
+        const Polygon& polygon,
+        const double test_path_length,
+        const double true_path_length,
+        const std::vector<bfreeman::Point>& test_path_points,
+        const std::vector<bfreeman::Point>& true_path_points,
+        unsigned short& passed_tests,
+        const bool verbose) {
+
+    double points_length = 0;
+    for (size_t i = 1; i < test_path_points.size(); i++) {
+        points_length += sqrt(pow(test_path_points[i].x - test_path_points[i - 1].x, 2) +
+                              pow(test_path_points[i].y - test_path_points[i - 1].y, 2));
+    }
+
+    bool passed = is_close(test_path_length, true_path_length)
+                  && is_close(points_length, test_path_length)
+                  && test_path_points.size() >= 2
+                  && is_close(test_path_points.front().x, true_path_points.front().x)
+                  && is_close(test_path_points.front().y, true_path_points.front().y)
+                  && is_close(test_path_points.back().x, true_path_points.back().x)
+                  && is_close(test_path_points.back().y, true_path_points.back().y);
+    if (verbose || !passed) {
+        print_label(name);
+        print_polygon(polygon);
+        print_path_lengths(test_path_length, true_path_length);
+        print_path_points(test_path_points, true_path_points);
+        print_seperation_line();
+    }
+    if (passed) {
+        std::cout << "PASSED " << name << std::endl;
+        passed_tests++;
+    } else {
+        std::cout << "FAILED " << name << std::endl;
+    }
+}
+
 void print_test_report(const size_t passed_tests, const size_t total_tests) {
     float percent = 100.0f * passed_tests / total_tests;
     std::cout << "PASSED " << passed_tests << " out of " << total_tests << " tests ("
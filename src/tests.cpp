@@ -1,10 +1,879 @@
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
 #include "dijkstra_polygon.hpp"
+#include "polygon_geometry.hpp"
+#include "polygon_index.hpp"
+#include "route_stream.hpp"
+#include "triangulation_index.hpp"
 #include "test_util.hpp"
 #include "test_data_reader.hpp"
 #include <iostream>
 
+/*
+ * A long hole edge nearly parallel to the chord between the tips
+ * of two other holes, half a unit from it: testing every edge
+ * blocks the chord through the tolerance of orientation, the
+ * EdgeGrid (with cells shrunk by a field of small holes) does not
+ * test the far edge and keeps it, in both directions alike
+ */
+void test_edge_grid_tolerance(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = {{{-5, -5}, {20, -5}, {20, 5}, {-5, 5}},
+                       {{-1, .5}, {0, 0}, {-1, -.5}},
+                       {{1.2, -2}, {1.2, -1}, {1, 0}},
+                       {{11.5, 1.1e-6}, {6.5, 3}, {1.5, 0}}};
+    for (size_t a = 0; a < 25; a++) {
+        for (size_t b = 0; b < 25; b++) {
+            double x = 14 + 0.2 * a, y = -2.5 + 0.2 * b;
+            polygon.push_back({{x, y}, {x + 0.1, y}, {x + 0.1, y + 0.1}, {x, y + 0.1}});
+        }
+    }
+    bfreeman::Segment chord = {{1, 0}, {0, 0}};
+    bfreeman::Segment reverse = {chord.p2, chord.p1};
+    bfreeman::EdgeGrid edge_grid(polygon);
+    bfreeman::EdgeBatch edge_batch(polygon);
+
+    // the nodes of (1, 0) and (0, 0)
+    const uint32_t from = 2 + 4 + 3 + 2, to = 2 + 4 + 1;
+
+    bfreeman::IndexOptions brute_force_options;
+    brute_force_options.edge_grid = false;
+    bfreeman::PolygonIndex brute_force_index(polygon, brute_force_options);
+    bfreeman::PolygonIndex grid_index(polygon);
+    bfreeman::CompactGraphView brute_force_graph = brute_force_index.get_graph();
+    bfreeman::CompactGraphView grid_graph = grid_index.get_graph();
+
+    // every edge kept testing every edge is kept through the grid, which only adds from -> to
+    size_t missing = 0, extra = 0;
+    bool chord_kept = false;
+    for (size_t node = 0; node < grid_graph.node_count; node++) {
+        std::vector<uint32_t> brute_force_row(brute_force_graph.targets + brute_force_graph.offsets[node],
+                                              brute_force_graph.targets + brute_force_graph.offsets[node + 1]);
+        std::vector<uint32_t> grid_row(grid_graph.targets + grid_graph.offsets[node],
+                                       grid_graph.targets + grid_graph.offsets[node + 1]);
+        std::sort(brute_force_row.begin(), brute_force_row.end());
+        std::sort(grid_row.begin(), grid_row.end());
+        std::vector<uint32_t> difference;
+        std::set_difference(brute_force_row.begin(), brute_force_row.end(), grid_row.begin(), grid_row.end(),
+                            std::back_inserter(difference));
+        missing += difference.size();
+        difference.clear();
+        std::set_difference(grid_row.begin(), grid_row.end(), brute_force_row.begin(), brute_force_row.end(),
+                            std::back_inserter(difference));
+        for (uint32_t target : difference) {
+            if (node == from && target == to) {
+                chord_kept = true;
+            } else {
+                extra++;
+            }
+        }
+    }
+
+    if (edge_batch.intersects(chord) && edge_batch.intersects(reverse) &&
+        !edge_grid.intersects(chord) && !edge_grid.intersects(reverse) &&
+        missing == 0 && extra == 0 && chord_kept) {
+        std::cout << "PASSED edge_grid_tolerance" << std::endl;
+        passed_tests++;
+    } else {
+        std::cout << "FAILED edge_grid_tolerance: " << missing << " edges missing and " << extra
+                  << " extra through the grid, chord " << (chord_kept ? "kept" : "not kept") << std::endl;
+    }
+    total_tests++;
+}
+
+
+/*
+ * A wall across a 10x10 square between start and end, which the
+ * path has to go around through two corners of the square, given
+ * either way round, and a wall across the whole square, which
+ * leaves no path at all, through every search that takes obstacles
+ */
+void test_obstacles(unsigned short& passed_tests, size_t& total_tests, const bool verbose) {
+    Polygon square = {{{0, 0}, {10, 0}, {10, 10}, {0, 10}}};
+    bfreeman::Point start = {1, 5}, end = {9, 5};
+    std::vector<bfreeman::Point> detour = {start, {0, 0}, {10, 0}, end};
+    double detour_length = 10 + 2 * sqrt(26);
+
+    struct ObstacleCase {
+        std::string name;
+        bfreeman::ObstacleSet obstacles;
+        bool leaves_path;
+    };
+    std::vector<ObstacleCase> cases = {
+            {"obstacle_wall", bfreeman::ObstacleSet({{{4, 2}, {6, 2}, {6, 8}, {4, 8}}}), true},
+            {"obstacle_clockwise_wall", bfreeman::ObstacleSet({{{4, 2}, {4, 8}, {6, 8}, {6, 2}}}), true},
+            {"obstacle_full_wall", bfreeman::ObstacleSet({{{4, -1}, {6, -1}, {6, 11}, {4, 11}}}), false}
+    };
+
+    bfreeman::IndexOptions table_options;
+    table_options.all_pairs = true;
+    bfreeman::PolygonIndex index(square, table_options);
+
+    for (const ObstacleCase& obstacle_case : cases) {
+        auto check = [&](const std::string& name, const bfreeman::DijkstraData& data) {
+            if (obstacle_case.leaves_path) {
+                run_length_test(name, square, data.distance, detour_length, data.path, detour, passed_tests, verbose);
+            } else if (data.distance == __DBL_MAX__) {
+                std::cout << "PASSED " << name << std::endl;
+                passed_tests++;
+            } else {
+                std::cout << "FAILED " << name << ": found a path of length " << data.distance << std::endl;
+            }
+            total_tests++;
+        };
+
+        bfreeman::QueryOptions options;
+        options.obstacles = &obstacle_case.obstacles;
+        const bfreeman::SearchAlgorithm searches[3] = {bfreeman::DIJKSTRA, bfreeman::A_STAR, bfreeman::TABLE_LOOKUP};
+        const std::string search_names[3] = {"_dijkstra", "_a_star", "_table"};
+        for (size_t k = 0; k < 3; k++) {
+            options.search = searches[k];
+            check(obstacle_case.name + search_names[k], index.dijkstra_path(start, end, options));
+        }
+        options.search = bfreeman::DIJKSTRA;
+
+        bfreeman::ShortestPathTree tree = index.shortest_path_tree(start, options);
+        check(obstacle_case.name + "_tree", index.tree_path(tree, end, options));
+
+        // the goal straight across the wall is the only one
+        bfreeman::GoalPath goal_path = index.nearest_goal(start, {end}, options);
+        size_t goal = obstacle_case.leaves_path ? 0 : bfreeman::NO_GOAL;
+        if (goal_path.goal == goal) {
+            check(obstacle_case.name + "_goal", goal_path.dijkstra_data);
+        } else {
+            std::cout << "FAILED " << obstacle_case.name << "_goal: picked goal " << goal_path.goal << std::endl;
+            total_tests++;
+        }
+    }
+}
+
+/*
+ * Goals on either side of a hole: the one straight across it is
+ * the nearest in a straight line but the farthest by path, so
+ * nearest_goal must still pick the one beside start, wherever
+ * it is listed, and skip the goals it is told to reject
+ */
+void test_nearest_goal(unsigned short& passed_tests, size_t& total_tests, const bool verbose) {
+    Polygon polygon = {{{0, 0}, {20, 0}, {20, 10}, {0, 10}},
+                       {{3, 1}, {5, 1}, {5, 9}, {3, 9}}};
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::Point start = {2, 5};
+    bfreeman::Point across = {6, 5}, beside = {2, 0.5}, far = {18, 5};
+    std::vector<bfreeman::Point> true_path = {start, beside};
+
+    const std::vector<bfreeman::Point> goal_lists[2] = {{across, beside, far}, {far, beside, across}};
+    for (size_t k = 0; k < 2; k++) {
+        std::string name = "nearest_goal_" + std::to_string(k);
+        bfreeman::GoalPath goal_path = index.nearest_goal(start, goal_lists[k]);
+        if (goal_path.goal == 1) {
+            run_path_test(name, polygon, goal_path.dijkstra_data.distance, 4.5,
+                          goal_path.dijkstra_data.path, true_path, passed_tests, verbose);
+        } else {
+            std::cout << "FAILED " << name << ": picked goal " << goal_path.goal << std::endl;
+        }
+        total_tests++;
+    }
+
+    // a goal in the hole, nearest of all in a straight line, and one outside the polygon, both rejected
+    bfreeman::QueryOptions reject_options;
+    reject_options.endpoints = bfreeman::REJECT_ENDPOINTS;
+    bfreeman::GoalPath goal_path = index.nearest_goal(start, {{4, 5}, {25, 5}, beside, across}, reject_options);
+    if (goal_path.goal == 2) {
+        run_path_test("nearest_goal_rejected", polygon, goal_path.dijkstra_data.distance, 4.5,
+                      goal_path.dijkstra_data.path, true_path, passed_tests, verbose);
+    } else {
+        std::cout << "FAILED nearest_goal_rejected: picked goal " << goal_path.goal << std::endl;
+    }
+    total_tests++;
+}
+
+/*
+ * Batches of distinct queries across several workers, each
+ * batch result against the same query run on its own: random
+ * queries between holes, each also swapped end for start, one
+ * from outside the polygon and one repeated, and paths from one
+ * start point to the ends of all of them
+ */
+/*
+ * A 12 by 12 square with a 3 by 3 grid of holes of uneven widths
+ * and offsets, so that random queries between them go around
+ * different sides of different holes
+ */
+Polygon staggered_holes() {
+    Polygon polygon = {{{0, 0}, {12, 0}, {12, 12}, {0, 12}}};
+    for (size_t a = 0; a < 3; a++) {
+        for (size_t b = 0; b < 3; b++) {
+            double x = 4.0 * a + 1 + 0.5 * ((a + b) % 2), y = 4.0 * b + 1, w = 1 + 0.5 * ((a * b) % 3);
+            polygon.push_back({{x, y}, {x + w, y}, {x + w, y + 2}, {x, y + 2}});
+        }
+    }
+    return polygon;
+}
+
+/*
+ * count queries between random points inside the polygon of
+ * index, with coordinates between 0 and size, each query also
+ * swapped end for start if swapped is set
+ */
+std::vector<std::pair<bfreeman::Point, bfreeman::Point>> random_queries(
+        const bfreeman::PolygonIndex& index,
+        const double size,
+        const size_t count,
+        const unsigned seed,
+        const bool swapped = false
+) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coordinate(0, size);
+    auto random_inside = [&]() {
+        bfreeman::Point point;
+        do {
+            point = {coordinate(rng), coordinate(rng)};
+        } while (index.locate(point).point_class != bfreeman::POINT_INSIDE);
+        return point;
+    };
+    std::vector<std::pair<bfreeman::Point, bfreeman::Point>> queries;
+    for (size_t k = 0; k < count; k++) {
+        bfreeman::Point start = random_inside(), end = random_inside();
+        queries.push_back({start, end});
+        if (swapped) queries.push_back({end, start});
+    }
+    return queries;
+}
+
+/*
+ * Batches of distinct queries across several workers, each
+ * batch result against the same query run on its own: random
+ * queries between holes, each also swapped end for start, one
+ * from outside the polygon and one repeated, and paths from one
+ * start point to the ends of all of them
+ */
+void test_batches(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = staggered_holes();
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::TriangulationIndex triangulation_index(polygon);
+
+    std::vector<std::pair<bfreeman::Point, bfreeman::Point>> queries = random_queries(index, 12, 20, 2, true);
+    queries.push_back({{-1, -1}, queries[0].second});
+    queries.push_back(queries[0]);
+    std::vector<bfreeman::Point> ends;
+    for (const auto& query : queries) ends.push_back(query.second);
+    bfreeman::ShortestPathTree tree = index.shortest_path_tree(queries[0].first);
+
+    auto check = [&](const std::string& name, const std::vector<bfreeman::DijkstraData>& results,
+                     const std::function<bfreeman::DijkstraData(size_t)>& single) {
+        size_t differing = results.size() == queries.size() ? 0 : queries.size();
+        for (size_t k = 0; k < results.size() && k < queries.size(); k++) {
+            bfreeman::DijkstraData expected = single(k);
+            if (results[k].distance != expected.distance || results[k].path != expected.path) differing++;
+        }
+        if (differing == 0) {
+            std::cout << "PASSED " << name << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << name << ": " << differing << " of " << queries.size()
+                      << " results differ from the same query on its own" << std::endl;
+        }
+        total_tests++;
+    };
+
+    check("batch_index", index.dijkstra_paths(queries, 4), [&](size_t k) {
+        return index.dijkstra_path(queries[k].first, queries[k].second);
+    });
+    check("batch_tree", index.tree_paths(tree, ends, 4), [&](size_t k) {
+        return index.tree_path(tree, ends[k]);
+    });
+    check("batch_triangulation", triangulation_index.dijkstra_paths(queries, 4), [&](size_t k) {
+        return triangulation_index.dijkstra_path(queries[k].first, queries[k].second);
+    });
+}
+
+/*
+ * One context reused for queries of every kind, each against
+ * the same query with a context of its own: triangulation, A*
+ * and table lookup queries and nearest goals, in turn, between
+ * distinct random points, so every query starts from state left
+ * by a different one
+ */
+void test_context(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = staggered_holes();
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::IndexOptions table_options;
+    table_options.all_pairs = true;
+    bfreeman::PolygonIndex table_index(polygon, table_options);
+    bfreeman::TriangulationIndex triangulation_index(polygon);
+    bfreeman::QueryOptions a_star_options;
+    a_star_options.search = bfreeman::A_STAR;
+    bfreeman::QueryOptions lookup_options;
+    lookup_options.search = bfreeman::TABLE_LOOKUP;
+
+    std::vector<std::pair<bfreeman::Point, bfreeman::Point>> queries = random_queries(index, 12, 12, 3);
+    bfreeman::QueryContext context;
+    size_t differing = 0;
+    auto compare = [&](const bfreeman::DijkstraData& result, const bfreeman::DijkstraData& expected) {
+        if (result.distance != expected.distance || result.path != expected.path) differing++;
+    };
+    for (size_t k = 0; k < queries.size(); k++) {
+        const bfreeman::Point& start = queries[k].first;
+        const bfreeman::Point& end = queries[k].second;
+        const bfreeman::Point& other_end = queries[(k + 1) % queries.size()].second;
+        compare(triangulation_index.dijkstra_path(start, end, context), triangulation_index.dijkstra_path(start, end));
+        compare(index.dijkstra_path(end, start, context, a_star_options),
+                index.dijkstra_path(end, start, a_star_options));
+        compare(table_index.dijkstra_path(start, other_end, context, lookup_options),
+                table_index.dijkstra_path(start, other_end, lookup_options));
+        bfreeman::GoalPath goal_path = index.nearest_goal(start, {end, other_end});
+        if (index.nearest_goal(start, {end, other_end}, context) != goal_path.goal) differing++;
+        compare(context.result, goal_path.dijkstra_data);
+    }
+    if (differing == 0) {
+        std::cout << "PASSED context_reuse" << std::endl;
+        passed_tests++;
+    } else {
+        std::cout << "FAILED context_reuse: " << differing << " of " << 5 * queries.size()
+                  << " results differ from the same query with a context of its own" << std::endl;
+    }
+    total_tests++;
+}
+
+/*
+ * Distinct queries sent through a text route_stream, with a
+ * comment, a malformed line and a query from outside the polygon
+ * among them, small batches spread over several workers: every
+ * answer must come back in the order of its query, the same as
+ * that query run on its own
+ */
+void test_route_stream(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = staggered_holes();
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::TriangulationIndex triangulation_index(polygon);
+
+    std::vector<std::pair<bfreeman::Point, bfreeman::Point>> queries = random_queries(index, 12, 30, 4);
+    queries.push_back({{-1, -1}, queries[0].second});
+    const size_t malformed = 7;
+
+    std::string queries_path = (std::filesystem::temp_directory_path() / "route_stream.queries").string();
+    std::string answers_path = (std::filesystem::temp_directory_path() / "route_stream.answers").string();
+    {
+        std::ofstream queries_file(queries_path);
+        queries_file << std::setprecision(17) << "// start.x start.y end.x end.y\n";
+        for (size_t k = 0; k < queries.size(); k++) {
+            if (k == malformed) queries_file << "1 2 three\n";
+            queries_file << queries[k].first.x << " " << queries[k].first.y << ", "
+                         << queries[k].second.x << " " << queries[k].second.y << "\n";
+        }
+    }
+
+    auto check = [&](const std::string& name, const std::function<bfreeman::StreamStatus(int, int)>& stream,
+                     const std::function<bfreeman::DijkstraData(size_t)>& single) {
+        int in_fd = open(queries_path.c_str(), O_RDONLY);
+        int out_fd = open(answers_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bfreeman::StreamStatus status = stream(in_fd, out_fd);
+        close(in_fd);
+        close(out_fd);
+
+        std::ifstream answers_file(answers_path);
+        std::string line;
+        size_t differing = 0, answers = 0;
+        for (size_t k = 0; k < queries.size(); k++) {
+            if (k == malformed) {
+                if (!std::getline(answers_file, line) || line != "error") differing++;
+                answers++;
+            }
+            bfreeman::DijkstraData answer = {{}, -1};
+            size_t point_count = 0;
+            if (!std::getline(answers_file, line)) break;
+            answers++;
+            std::istringstream numbers(line);
+            numbers >> answer.distance >> point_count;
+            answer.path.resize(point_count);
+            for (bfreeman::Point& point : answer.path) numbers >> point.x >> point.y;
+            bfreeman::DijkstraData expected = single(k);
+            if (!numbers || answer.distance != expected.distance || answer.path != expected.path) differing++;
+        }
+        bool extra = static_cast<bool>(std::getline(answers_file, line));
+        if (status == bfreeman::STREAM_OK && answers == queries.size() + 1 && !extra && differing == 0) {
+            std::cout << "PASSED " << name << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << name << ": " << answers << " answers to " << queries.size() + 1 << " lines, "
+                      << differing << " of them differing from the same query on its own" << std::endl;
+        }
+        total_tests++;
+    };
+
+    bfreeman::StreamOptions stream_options;
+    stream_options.threads = 3;
+    stream_options.batch_size = 4;
+    check("stream_index", [&](int in_fd, int out_fd) {
+        return bfreeman::route_stream(index, in_fd, out_fd, stream_options);
+    }, [&](size_t k) {
+        return index.dijkstra_path(queries[k].first, queries[k].second);
+    });
+    check("stream_triangulation", [&](int in_fd, int out_fd) {
+        return bfreeman::route_stream(triangulation_index, in_fd, out_fd, stream_options);
+    }, [&](size_t k) {
+        return triangulation_index.dijkstra_path(queries[k].first, queries[k].second);
+    });
+    std::filesystem::remove(queries_path);
+    std::filesystem::remove(answers_path);
+}
+
+/*
+ * Endpoints outside the polygon and in a hole, rejected or
+ * snapped onto the nearest edge, through a PolygonIndex and a
+ * TriangulationIndex: a rejected query has no path, a snapped
+ * one the path between the points the endpoints snap to, and
+ * a query with both endpoints inside is left as it is
+ */
+void test_endpoints(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = {{{0, 0}, {20, 0}, {20, 10}, {0, 10}},
+                       {{3, 1}, {5, 1}, {5, 9}, {3, 9}}};
+    bfreeman::PolygonIndex index(polygon);
+    bfreeman::TriangulationIndex triangulation_index(polygon);
+    bfreeman::QueryOptions reject_options;
+    reject_options.endpoints = bfreeman::REJECT_ENDPOINTS;
+    bfreeman::QueryOptions snap_options;
+    snap_options.endpoints = bfreeman::SNAP_ENDPOINTS;
+
+    // a query, and the points its endpoints snap to
+    struct EndpointCase {
+        std::string name;
+        bfreeman::Point start, end, snapped_start, snapped_end;
+    };
+    const EndpointCase cases[] = {
+            {"outside_start", {-1, 6}, {18, 5}, {0, 6}, {18, 5}},
+            {"hole_start", {4.6, 5}, {1, 2}, {5, 5}, {1, 2}},
+            {"outside_end", {1, 8}, {21, 6}, {1, 8}, {20, 6}},
+            {"inside", {1, 8}, {18, 5}, {1, 8}, {18, 5}}
+    };
+    auto near = [](const bfreeman::Point& p, const bfreeman::Point& q) {
+        return fabs(p.x - q.x) <= 10e-7 && fabs(p.y - q.y) <= 10e-7;
+    };
+    for (const EndpointCase& endpoint_case : cases) {
+        bool inside = endpoint_case.start == endpoint_case.snapped_start &&
+                      endpoint_case.end == endpoint_case.snapped_end;
+        auto check = [&](const std::string& name, const bfreeman::DijkstraData& expected,
+                         const bfreeman::DijkstraData& rejected, const bfreeman::DijkstraData& snapped) {
+            bool rejected_right = inside ? rejected.distance == expected.distance && rejected.path == expected.path
+                                         : rejected.path.empty() && rejected.distance == __DBL_MAX__;
+            bool snapped_right = !snapped.path.empty() &&
+                                 fabs(snapped.distance - expected.distance) <= 10e-7 &&
+                                 near(snapped.path.front(), endpoint_case.snapped_start) &&
+                                 near(snapped.path.back(), endpoint_case.snapped_end) &&
+                                 index.locate(snapped.path.front()).point_class == bfreeman::POINT_INSIDE &&
+                                 index.locate(snapped.path.back()).point_class == bfreeman::POINT_INSIDE;
+            if (inside) snapped_right = snapped.distance == expected.distance && snapped.path == expected.path;
+            if (rejected_right && snapped_right) {
+                std::cout << "PASSED " << name << std::endl;
+                passed_tests++;
+            } else {
+                std::cout << "FAILED " << name << ": " << (rejected_right ? "" : "wrongly rejected, ")
+                          << "snapped distance " << snapped.distance << " against " << expected.distance << std::endl;
+            }
+            total_tests++;
+        };
+        check("endpoints_" + endpoint_case.name + "_index",
+              index.dijkstra_path(endpoint_case.snapped_start, endpoint_case.snapped_end),
+              index.dijkstra_path(endpoint_case.start, endpoint_case.end, reject_options),
+              index.dijkstra_path(endpoint_case.start, endpoint_case.end, snap_options));
+        check("endpoints_" + endpoint_case.name + "_triangulation",
+              triangulation_index.dijkstra_path(endpoint_case.snapped_start, endpoint_case.snapped_end),
+              triangulation_index.dijkstra_path(endpoint_case.start, endpoint_case.end, reject_options),
+              triangulation_index.dijkstra_path(endpoint_case.start, endpoint_case.end, snap_options));
+    }
+}
+
+/*
+ * A table index updated a step at a time (a hole inserted, two
+ * vertices moved to new points and a hole removed), after each
+ * step against an index built from scratch over the same polygon
+ */
+void test_updates(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon polygon = {{{0, 0}, {12, 0}, {12, 12}, {0, 12}},
+                       {{2, 2}, {4, 2}, {4, 4}, {2, 4}},
+                       {{7, 7}, {9, 7}, {9, 9}, {7, 9}}};
+    bfreeman::IndexOptions table_options;
+    table_options.all_pairs = true;
+    bfreeman::PolygonIndex updated_index(polygon, table_options);
+    bfreeman::QueryOptions lookup_options;
+    lookup_options.search = bfreeman::TABLE_LOOKUP;
+    bfreeman::Point start = {1, 1}, end = {11, 10};
+
+    // each row of the graph as (target, weight) pairs, which an update may list in another order
+    auto sorted_rows = [](const bfreeman::CompactGraphView& graph) {
+        std::vector<std::vector<std::pair<uint32_t, double>>> rows(graph.node_count);
+        for (size_t node = 0; node < graph.node_count; node++) {
+            for (size_t k = graph.offsets[node]; k < graph.offsets[node + 1]; k++) {
+                rows[node].push_back({graph.targets[k], graph.weights[k]});
+            }
+            std::sort(rows[node].begin(), rows[node].end());
+        }
+        return rows;
+    };
+
+    auto check = [&](const std::string& name, const bool updated) {
+        bfreeman::PolygonIndex built_index(polygon, table_options);
+        bfreeman::DijkstraData updated_data = updated_index.dijkstra_path(start, end, lookup_options);
+        bfreeman::DijkstraData built_data = built_index.dijkstra_path(start, end, lookup_options);
+        bool same_polygon = updated_index.get_polygon() == polygon;
+        bool same_graph = sorted_rows(updated_index.get_graph()) == sorted_rows(built_index.get_graph());
+        bool same_path = fabs(updated_data.distance - built_data.distance) <= built_data.distance * 10e-12 &&
+                         updated_data.path == built_data.path;
+        if (updated && same_polygon && same_graph && same_path) {
+            std::cout << "PASSED " << name << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << name << ": " << (updated ? "" : "update refused, ")
+                      << (same_polygon ? "" : "polygon differs, ") << (same_graph ? "" : "graph differs, ")
+                      << "distance " << updated_data.distance << " against " << built_data.distance << std::endl;
+        }
+        total_tests++;
+    };
+
+    std::vector<bfreeman::Point> hole = {{2, 8}, {4, 8}, {3, 10}};
+    polygon.push_back(hole);
+    check("update_insert_hole", updated_index.insert_hole(hole, 2));
+
+    polygon[1][2] = {5, 4.5};
+    check("update_move_hole_vertex", updated_index.move_vertex(bfreeman::IndexPair(1, 2), polygon[1][2], 2));
+
+    polygon[0][2] = {13, 12.5};
+    check("update_move_boundary_vertex", updated_index.move_vertex(bfreeman::IndexPair(0, 2), polygon[0][2]));
+
+    polygon.erase(polygon.begin() + 1);
+    check("update_remove_hole", updated_index.remove_hole(1, 2));
+}
+
+// a test file as read by load_test_data, and the name it was read by
+struct Fixture {
+    std::string name;
+    TestData data;
+};
+
+/*
+ * The graph of each fixture built every way an index builds
+ * one: in parallel, by the rotational sweep, reduced, written to
+ * a file and mapped back in, and over the boundary alone with
+ * the holes inserted after, each against the adjacency list and
+ * path of the fixture
+ */
+void test_index_builds(const std::vector<Fixture>& fixtures, unsigned short& passed_tests, size_t& total_tests,
+                       const bool verbose) {
+    for (const Fixture& fixture : fixtures) {
+        const std::string& name = fixture.name;
+        const Polygon& polygon = fixture.data.polygon;
+        const PointPair& start_end = fixture.data.start_end;
+        const AdjacencyList& true_al = fixture.data.adjacency_list;
+        const double& true_path_length = fixture.data.path_length;
+        const std::vector<bfreeman::Point>& true_path_points = fixture.data.path_points;
+
+        bfreeman::IndexOptions index_options;
+        index_options.threads = 2;
+        bfreeman::PolygonIndex index(polygon, index_options);
+        AdjacencyList index_al = index.adjacency_list(start_end.start, start_end.end);
+        bfreeman::DijkstraData index_data = index.dijkstra_path(start_end.start, start_end.end);
+
+        run_test(name + "_index", polygon, index_al, true_al, index_data.distance, true_path_length,
+                 index_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        bfreeman::IndexOptions sweep_options;
+        sweep_options.engine = bfreeman::ROTATIONAL_SWEEP;
+        bfreeman::PolygonIndex sweep_index(polygon, sweep_options);
+        AdjacencyList sweep_al = sweep_index.adjacency_list(start_end.start, start_end.end);
+        bfreeman::DijkstraData sweep_data = sweep_index.dijkstra_path(start_end.start, start_end.end);
+
+        run_test(name + "_sweep", polygon, sweep_al, true_al, sweep_data.distance, true_path_length,
+                 sweep_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        // the reduced graph keeps fewer edges than the fixture lists, so only its path is compared
+        bfreeman::IndexOptions reduced_options;
+        reduced_options.reduced = true;
+        bfreeman::PolygonIndex reduced_index(polygon, reduced_options);
+        bfreeman::DijkstraData reduced_data = reduced_index.dijkstra_path(start_end.start, start_end.end);
+
+        run_path_test(name + "_reduced", polygon, reduced_data.distance, true_path_length,
+                      reduced_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        bfreeman::IndexOptions table_options;
+        table_options.all_pairs = true;
+        bfreeman::QueryOptions lookup_options;
+        lookup_options.search = bfreeman::TABLE_LOOKUP;
+        bfreeman::PolygonIndex table_index(polygon, table_options);
+        std::string index_path = (std::filesystem::temp_directory_path() / (name + ".index")).string();
+        std::unique_ptr<bfreeman::PolygonIndex> saved_index;
+        if (table_index.save(index_path) == bfreeman::INDEX_FILE_OK &&
+            bfreeman::PolygonIndex::load(index_path, saved_index) == bfreeman::INDEX_FILE_OK) {
+            AdjacencyList saved_al = saved_index->adjacency_list(start_end.start, start_end.end);
+            bfreeman::DijkstraData saved_data =
+                    saved_index->dijkstra_path(start_end.start, start_end.end, lookup_options);
+
+            run_test(name + "_saved", polygon, saved_al, true_al, saved_data.distance, true_path_length,
+                     saved_data.path, true_path_points, passed_tests, verbose);
+        } else {
+            std::cout << "FAILED " << name << "_saved: could not save and load " << index_path << std::endl;
+        }
+        std::filesystem::remove(index_path);
+        total_tests++;
+
+        bfreeman::PolygonIndex updated_index({polygon[0]}, table_options);
+        for (size_t hole = 1; hole < polygon.size(); hole++) updated_index.insert_hole(polygon[hole], 2);
+        AdjacencyList updated_al = updated_index.adjacency_list(start_end.start, start_end.end);
+        bfreeman::DijkstraData updated_data =
+                updated_index.dijkstra_path(start_end.start, start_end.end, lookup_options);
+
+        run_test(name + "_updated", polygon, updated_al, true_al, updated_data.distance, true_path_length,
+                 updated_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+    }
+}
+
+/*
+ * The query of each fixture through every other search: A*,
+ * the shortest path tree of its start, an all-pairs table, the
+ * interval search over a triangulation, and the adjacency list
+ * alone in float and in int32_t millimetres
+ */
+void test_fixture_searches(const std::vector<Fixture>& fixtures, unsigned short& passed_tests, size_t& total_tests,
+                           const bool verbose) {
+    for (const Fixture& fixture : fixtures) {
+        const std::string& name = fixture.name;
+        const Polygon& polygon = fixture.data.polygon;
+        const PointPair& start_end = fixture.data.start_end;
+        const double& true_path_length = fixture.data.path_length;
+        const std::vector<bfreeman::Point>& true_path_points = fixture.data.path_points;
+
+        bfreeman::PolygonIndex index(polygon);
+        bfreeman::QueryOptions a_star_options;
+        a_star_options.search = bfreeman::A_STAR;
+        bfreeman::DijkstraData a_star_data = index.dijkstra_path(start_end.start, start_end.end, a_star_options);
+
+        run_path_test(name + "_a_star", polygon, a_star_data.distance, true_path_length,
+                      a_star_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        bfreeman::ShortestPathTree tree = index.shortest_path_tree(start_end.start);
+        bfreeman::DijkstraData tree_data = index.tree_path(tree, start_end.end);
+
+        run_path_test(name + "_tree", polygon, tree_data.distance, true_path_length,
+                      tree_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        bfreeman::IndexOptions table_options;
+        table_options.all_pairs = true;
+        bfreeman::PolygonIndex table_index(polygon, table_options);
+        bfreeman::QueryOptions lookup_options;
+        lookup_options.search = bfreeman::TABLE_LOOKUP;
+        bfreeman::DijkstraData table_data = table_index.dijkstra_path(start_end.start, start_end.end, lookup_options);
+
+        run_path_test(name + "_table", polygon, table_data.distance, true_path_length,
+                      table_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        bfreeman::TriangulationIndex triangulation_index(polygon);
+        bfreeman::DijkstraData triangulation_data = triangulation_index.dijkstra_path(start_end.start, start_end.end);
+
+        run_path_test(name + "_triangulation", polygon, triangulation_data.distance, true_path_length,
+                      triangulation_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+
+        const double millimetres = 1000;
+        std::vector<std::vector<bfreeman::BasicPoint<float>>> float_polygon;
+        std::vector<std::vector<bfreeman::BasicPoint<int32_t>>> int_polygon;
+        auto to_float = [](const bfreeman::Point& point) {
+            return (bfreeman::BasicPoint<float>) {(float) point.x, (float) point.y};
+        };
+        auto to_int = [&](const bfreeman::Point& point) {
+            return (bfreeman::BasicPoint<int32_t>) {(int32_t) std::lround(point.x * millimetres),
+                                                    (int32_t) std::lround(point.y * millimetres)};
+        };
+        for (const std::vector<bfreeman::Point>& ring : polygon) {
+            float_polygon.emplace_back();
+            int_polygon.emplace_back();
+            for (const bfreeman::Point& vertex : ring) {
+                float_polygon.back().push_back(to_float(vertex));
+                int_polygon.back().push_back(to_int(vertex));
+            }
+        }
+        bfreeman::BasicDijkstraData<float> float_data =
+                bfreeman::dijkstra_path(float_polygon, to_float(start_end.start), to_float(start_end.end));
+        bfreeman::BasicDijkstraData<int32_t> int_data =
+                bfreeman::dijkstra_path(int_polygon, to_int(start_end.start), to_int(start_end.end));
+
+        bfreeman::DijkstraData float_path = {{}, float_data.distance};
+        for (const auto& point : float_data.path) float_path.path.push_back({point.x, point.y});
+        bfreeman::DijkstraData int_path = {{}, int_data.distance / millimetres};
+        for (const auto& point : int_data.path) {
+            int_path.path.push_back({point.x / millimetres, point.y / millimetres});
+        }
+
+        run_path_test(name + "_float", polygon, float_path.distance, true_path_length,
+                      float_path.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+        run_path_test(name + "_int32", polygon, int_path.distance, true_path_length,
+                      int_path.path, true_path_points, passed_tests, verbose);
+        total_tests++;
+    }
+}
+
+/*
+ * Points of each fixture located: start and end inside, every
+ * vertex and edge midpoint on its edge, a point just off each
+ * hole edge in that hole, and a point past the top right corner
+ * of the boundary outside
+ */
+void test_locate(const std::vector<Fixture>& fixtures, unsigned short& passed_tests, size_t& total_tests) {
+    for (const Fixture& fixture : fixtures) {
+        const Polygon& polygon = fixture.data.polygon;
+        const PointPair& start_end = fixture.data.start_end;
+        bfreeman::PolygonIndex index(polygon);
+
+        bfreeman::Point outside = polygon[0][0];
+        for (const bfreeman::Point& vertex : polygon[0]) {
+            outside = {std::max(outside.x, vertex.x + 1), std::max(outside.y, vertex.y + 1)};
+        }
+        bool located = index.locate(start_end.start).point_class == bfreeman::POINT_INSIDE &&
+                       index.locate(start_end.end).point_class == bfreeman::POINT_INSIDE &&
+                       index.locate(outside).point_class == bfreeman::POINT_OUTSIDE;
+        for (size_t ring = 0; ring < polygon.size(); ring++) {
+            for (size_t j = 0; j < polygon[ring].size(); j++) {
+                const bfreeman::Point& a = polygon[ring][j];
+                const bfreeman::Point& b = polygon[ring][(j + 1) % polygon[ring].size()];
+                bfreeman::PointLocation midpoint = index.locate({(a.x + b.x) / 2, (a.y + b.y) / 2});
+                located = located && index.locate(a).point_class == bfreeman::POINT_ON_EDGE &&
+                          midpoint.point_class == bfreeman::POINT_ON_EDGE && midpoint.ring == ring && midpoint.edge == j;
+
+                // a hole winds counterclockwise, so its inside is left of its edges
+                if (ring == 0) continue;
+                bfreeman::Point in_hole = {(a.x + b.x) / 2 - (b.y - a.y) / 1000, (a.y + b.y) / 2 + (b.x - a.x) / 1000};
+                bfreeman::PointLocation hole = index.locate(in_hole);
+                located = located && hole.point_class == bfreeman::POINT_IN_HOLE && hole.ring == ring;
+            }
+        }
+        if (located) {
+            std::cout << "PASSED " << fixture.name << "_locate" << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << fixture.name << "_locate: a point was located in the wrong place" << std::endl;
+        }
+        total_tests++;
+    }
+}
+
+/*
+ * int32_t coordinates at the +-2^30 bound: the corner-to-corner
+ * diagonal, whose squared length is 2^63, and a query around a
+ * hole from corner to corner, each against the same in double
+ */
+void test_int32_bound(unsigned short& passed_tests, size_t& total_tests) {
+    const int32_t bound = 1 << 30;
+    std::vector<std::vector<bfreeman::BasicPoint<int32_t>>> extreme_polygon = {
+            {{-bound, -bound}, {bound, -bound}, {bound, bound}, {-bound, bound}},
+            {{-bound / 2, -bound / 2}, {bound / 4, -bound / 2}, {bound / 4, bound / 4}, {-bound / 2, bound / 4}}
+    };
+    std::vector<std::vector<bfreeman::Point>> extreme_double_polygon;
+    for (const auto& ring : extreme_polygon) {
+        extreme_double_polygon.emplace_back();
+        for (const auto& vertex : ring) extreme_double_polygon.back().push_back({(double) vertex.x, (double) vertex.y});
+    }
+    bfreeman::BasicPoint<int32_t> extreme_start = {-bound + 1, -bound + 1};
+    bfreeman::BasicPoint<int32_t> extreme_end = {bound - 1, bound - 1};
+    double diagonal = bfreeman::length((bfreeman::BasicSegment<int32_t>) {{-bound, -bound}, {bound, bound}});
+    bfreeman::BasicDijkstraData<int32_t> extreme_data =
+            bfreeman::dijkstra_path(extreme_polygon, extreme_start, extreme_end);
+    bfreeman::DijkstraData extreme_double_data =
+            bfreeman::dijkstra_path(extreme_double_polygon, {(double) extreme_start.x, (double) extreme_start.y},
+                                    {(double) extreme_end.x, (double) extreme_end.y});
+    if (fabs(diagonal - 2 * (double) bound * sqrt(2)) <= diagonal * 10e-15 &&
+        fabs(extreme_data.distance - extreme_double_data.distance) <= extreme_double_data.distance * 10e-15 &&
+        extreme_data.path.size() == extreme_double_data.path.size()) {
+        std::cout << "PASSED int32_bound" << std::endl;
+        passed_tests++;
+    } else {
+        std::cout << "FAILED int32_bound: diagonal " << diagonal << ", distance " << extreme_data.distance
+                  << " against " << extreme_double_data.distance << " in double" << std::endl;
+    }
+    total_tests++;
+}
+
+/*
+ * A grid of holes of uneven sizes, between which many routes
+ * around different sides of the holes are close in length: the
+ * paths between random points through the TriangulationIndex,
+ * A*, an all-pairs table and shortest path trees must be as
+ * short as the Dijkstra ones
+ */
+void test_hole_grid(unsigned short& passed_tests, size_t& total_tests) {
+    Polygon hole_grid = {{{0, 0}, {20, 0}, {20, 20}, {0, 20}}};
+    for (size_t a = 0; a < 4; a++) {
+        for (size_t b = 0; b < 4; b++) {
+            double x = 5.0 * a + 1 + 0.3 * ((a + 2 * b) % 3), y = 5.0 * b + 1 + 0.4 * ((2 * a + b) % 3);
+            double w = 2 + 0.5 * ((a * b) % 3), h = 2.5 - 0.5 * ((a + b) % 2);
+            hole_grid.push_back({{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}});
+        }
+    }
+    bfreeman::PolygonIndex index(hole_grid);
+    bfreeman::IndexOptions table_options;
+    table_options.all_pairs = true;
+    bfreeman::PolygonIndex table_index(hole_grid, table_options);
+    bfreeman::TriangulationIndex triangulation_index(hole_grid);
+    bfreeman::QueryOptions a_star_options;
+    a_star_options.search = bfreeman::A_STAR;
+    bfreeman::QueryOptions lookup_options;
+    lookup_options.search = bfreeman::TABLE_LOOKUP;
+
+    std::vector<std::pair<bfreeman::Point, bfreeman::Point>> queries = random_queries(index, 20, 500, 1);
+    std::vector<double> shortest;
+    for (const auto& query : queries) shortest.push_back(index.dijkstra_path(query.first, query.second).distance);
+
+    auto check = [&](const std::string& name, const std::function<double(const bfreeman::Point&,
+                                                                         const bfreeman::Point&)>& distance_of) {
+        size_t longer_paths = 0;
+        double worst_ratio = 1;
+        for (size_t k = 0; k < queries.size(); k++) {
+            double distance = distance_of(queries[k].first, queries[k].second);
+            if (!(fabs(distance - shortest[k]) <= shortest[k] * 10e-10)) {
+                longer_paths++;
+                worst_ratio = std::max(worst_ratio, distance / shortest[k]);
+            }
+        }
+        if (longer_paths == 0) {
+            std::cout << "PASSED " << name << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << name << ": " << longer_paths << " of " << queries.size()
+                      << " paths differ from the shortest, up to " << worst_ratio << " times as long" << std::endl;
+        }
+        total_tests++;
+    };
+
+    check("hole_grid_triangulation", [&](const bfreeman::Point& start, const bfreeman::Point& end) {
+        return triangulation_index.dijkstra_path(start, end).distance;
+    });
+    check("hole_grid_a_star", [&](const bfreeman::Point& start, const bfreeman::Point& end) {
+        return index.dijkstra_path(start, end, a_star_options).distance;
+    });
+    check("hole_grid_table", [&](const bfreeman::Point& start, const bfreeman::Point& end) {
+        return table_index.dijkstra_path(start, end, lookup_options).distance;
+    });
+    check("hole_grid_tree", [&](const bfreeman::Point& start, const bfreeman::Point& end) {
+        return index.tree_path(index.shortest_path_tree(start), end).distance;
+    });
+}
 
 int main(int argc, char** argv) {
     bool verbose = argc > 1 && std::strcmp(argv[1], "-v") == 0;
@@ -22,6 +891,7 @@ int main(int argc, char** argv) {
      */
 
     unsigned short passed_tests = 0;
+    size_t total_tests = 0;
 
     std::vector<std::string> names;
     std::vector<size_t> polygon_sizes;
@@ -109,31 +979,80 @@ int main(int argc, char** argv) {
      * also generates the data using dijkstra_polygon.
      * The file and generated results then are compared.
      */
+    std::vector<Fixture> fixtures;
     for (size_t i = 0; i < names.size(); i++) {
-        auto* polygon = (Polygon*) read_test_data(SHAPE, names[i], polygon_sizes[i]);
-        auto* start_end = (PointPair*) read_test_data(START_END, names[i], 0);
+        TestData test_data;
+        size_t bad_line = 0;
+        if (load_test_data(test_data_path(names[i]), test_data, &bad_line) != TEST_DATA_OK) {
+            std::cout << "FAILED " << names[i] << ": could not read line " << bad_line << " of "
+                      << test_data_path(names[i]) << std::endl;
+            continue;
+        }
+        const Polygon& polygon = test_data.polygon;
+        const PointPair& start_end = test_data.start_end;
+        const AdjacencyList& true_al = test_data.adjacency_list;
+        const double& true_path_length = test_data.path_length;
+        const std::vector<bfreeman::Point>& true_path_points = test_data.path_points;
 
-        AdjacencyList test_al = bfreeman::generate_adjacency_list(*polygon, start_end->start, start_end->end);
-        auto* true_al = (AdjacencyList*) read_test_data(ADJACENCY_LIST, names[i], adjacency_list_sizes[i]);
+        AdjacencyList test_al = bfreeman::generate_adjacency_list(polygon, start_end.start, start_end.end);
 
-        bfreeman::DijkstraData dijkstra_data = bfreeman::dijkstra_path(*polygon, start_end->start, start_end->end);
+        bfreeman::DijkstraData dijkstra_data = bfreeman::dijkstra_path(polygon, start_end.start, start_end.end);
 
-        auto* true_path_length = (double*) read_test_data(PATH_LENGTH, names[i], 0);
+        run_test(names[i], polygon, test_al, true_al, dijkstra_data.distance, true_path_length,
+                 dijkstra_data.path, true_path_points, passed_tests, verbose);
+        total_tests++;
 
-        auto* true_path_points = (std::vector<bfreeman::Point>*)
-                read_test_data(PATH_POINTS, names[i], 0);
+        // the same file read a section at a time by read_test_data, which load_test_data must agree with
+        auto* read_polygon = (Polygon*) read_test_data(SHAPE, names[i], polygon_sizes[i]);
+        auto* read_start_end = (PointPair*) read_test_data(START_END, names[i], 0);
+        auto* read_al = (AdjacencyList*) read_test_data(ADJACENCY_LIST, names[i], adjacency_list_sizes[i]);
+        auto* read_path_length = (double*) read_test_data(PATH_LENGTH, names[i], 0);
+        auto* read_path_points = (std::vector<bfreeman::Point>*) read_test_data(PATH_POINTS, names[i], 0);
 
-        run_test(names[i], *polygon, test_al, *true_al, dijkstra_data.distance, *true_path_length,
-                 dijkstra_data.path, *true_path_points, passed_tests, verbose);
+        bool same_edges = read_al->size() == true_al.size();
+        for (size_t row = 0; same_edges && row < true_al.size(); row++) {
+            same_edges = (*read_al)[row].size() == true_al[row].size();
+            for (size_t k = 0; same_edges && k < true_al[row].size(); k++) {
+                const bfreeman::Edge& a = (*read_al)[row][k];
+                const bfreeman::Edge& b = true_al[row][k];
+                same_edges = a.idxp.i == b.idxp.i && a.idxp.j == b.idxp.j && a.idxp.interior == b.idxp.interior &&
+                             a.distance == b.distance;
+            }
+        }
+        if (*read_polygon == polygon && read_start_end->start == start_end.start &&
+            read_start_end->end == start_end.end && same_edges && *read_path_length == true_path_length &&
+            *read_path_points == true_path_points) {
+            std::cout << "PASSED " << names[i] << "_fixture" << std::endl;
+            passed_tests++;
+        } else {
+            std::cout << "FAILED " << names[i] << "_fixture: load_test_data and read_test_data disagree" << std::endl;
+        }
+        total_tests++;
 
-        delete polygon;
-        delete start_end;
-        delete true_al;
-        delete true_path_length;
-        delete true_path_points;
+        delete read_polygon;
+        delete read_start_end;
+        delete read_al;
+        delete read_path_length;
+        delete read_path_points;
+
+        fixtures.push_back({names[i], std::move(test_data)});
     }
 
-    print_test_report(passed_tests, names.size());
+    test_index_builds(fixtures, passed_tests, total_tests, verbose);
+    test_fixture_searches(fixtures, passed_tests, total_tests, verbose);
+    test_locate(fixtures, passed_tests, total_tests);
+    test_edge_grid_tolerance(passed_tests, total_tests);
+    test_obstacles(passed_tests, total_tests, verbose);
+    test_nearest_goal(passed_tests, total_tests, verbose);
+    test_endpoints(passed_tests, total_tests);
+    test_batches(passed_tests, total_tests);
+    test_context(passed_tests, total_tests);
+    test_route_stream(passed_tests, total_tests);
+    test_updates(passed_tests, total_tests);
+    test_int32_bound(passed_tests, total_tests);
+    test_hole_grid(passed_tests, total_tests);
+
+    print_test_report(passed_tests, total_tests);
 
     return 0;
 }
\ No newline at end of file
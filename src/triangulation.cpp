@@ -0,0 +1,463 @@
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include "triangulation.hpp"
+
+namespace bfreeman {
+
+const uint32_t NIL = UINT32_MAX;
+
+// positive if a, b, c turn counterclockwise
+double turn(const Point& a, const Point& b, const Point& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/*
+ * The order the sweep meets the vertices in: from the top down,
+ * and from left to right along a horizontal line, as if the
+ * polygon were rotated a little clockwise
+ */
+struct SweepOrder {
+    const std::vector<Point>* points;
+
+    // vertex a is met before vertex b
+    bool operator()(const uint32_t a, const uint32_t b) const {
+        const Point& p = (*points)[a];
+        const Point& q = (*points)[b];
+        if (p.y != q.y) return p.y > q.y;
+        if (p.x != q.x) return p.x < q.x;
+        return a < b;
+    }
+};
+
+enum VertexType {
+    START = 0,    // both neighbors below, interior angle under 180 degrees
+    SPLIT = 1,    // both neighbors below, interior angle over 180 degrees
+    END = 2,      // both neighbors above, interior angle under 180 degrees
+    MERGE = 3,    // both neighbors above, interior angle over 180 degrees
+    REGULAR = 4   // one neighbor above and one below
+};
+
+/*
+ * The rings of a polygon linked so that the interior is always
+ * on the left: the boundary counterclockwise and the holes
+ * clockwise, whichever way they were given
+ */
+struct Rings {
+    std::vector<Point> points;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> prev;
+};
+
+Rings link_rings(const std::vector<std::vector<Point>>& polygon) {
+    Rings rings;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        const std::vector<Point>& ring = polygon[i];
+        uint32_t first = (uint32_t) rings.points.size(), size = (uint32_t) ring.size();
+        rings.points.insert(rings.points.end(), ring.begin(), ring.end());
+
+        double area = 0;
+        for (size_t j = 0, k = ring.size() - 1; j < ring.size(); k = j++) {
+            area += (ring[k].x - ring[j].x) * (ring[j].y + ring[k].y);
+        }
+        bool forward = (i == 0) == (area > 0);
+        for (uint32_t j = 0; j < size; j++) {
+            uint32_t after = first + (j + 1) % size, before = first + (j + size - 1) % size;
+            rings.next.push_back(forward ? after : before);
+            rings.prev.push_back(forward ? before : after);
+        }
+    }
+    return rings;
+}
+
+/*
+ * The left boundary edges crossing the sweep line, from left to
+ * right. Edge v runs from vertex v down to rings.next[v]; edges
+ * never cross, so comparing an endpoint of one to the other is
+ * enough to order them.
+ */
+struct EdgeOrder {
+    using is_transparent = void;
+    const Rings* rings;
+
+    // vertex v, to be placed among the edges
+    struct Probe {
+        uint32_t v;
+    };
+
+    // positive if point p is to the right of (on the interior side of) edge e
+    double side(const uint32_t e, const Point& p) const {
+        return turn(rings->points[e], rings->points[rings->next[e]], p);
+    }
+
+    bool operator()(const uint32_t e, const uint32_t f) const {
+        if (e == f) return false;
+        if (SweepOrder {&rings->points}(f, e)) {
+            double s = side(f, rings->points[e]);
+            if (s == 0) s = side(f, rings->points[rings->next[e]]);
+            return s < 0;
+        }
+        double s = side(e, rings->points[f]);
+        if (s == 0) s = side(e, rings->points[rings->next[f]]);
+        return s > 0;
+    }
+
+    bool operator()(const uint32_t e, const Probe& probe) const {
+        return side(e, rings->points[probe.v]) > 0;
+    }
+
+    bool operator()(const Probe& probe, const uint32_t e) const {
+        return side(e, rings->points[probe.v]) < 0;
+    }
+};
+
+/*
+ * The diagonals that split the polygon into pieces monotone in
+ * the sweep order, by a sweep from the top down that connects
+ * every split vertex up and every merge vertex down (de Berg et
+ * al., Computational Geometry, chapter 3). Holes need no special
+ * treatment, and the sweep takes O(n log n).
+ */
+std::vector<std::pair<uint32_t, uint32_t>> monotone_diagonals(const Rings& rings) {
+    const std::vector<Point>& points = rings.points;
+    uint32_t n = (uint32_t) points.size();
+    SweepOrder order = {&points};
+
+    std::vector<uint32_t> sweep(n);
+    std::vector<VertexType> types(n);
+    for (uint32_t v = 0; v < n; v++) {
+        sweep[v] = v;
+        uint32_t u = rings.prev[v], w = rings.next[v];
+        bool convex = turn(points[u], points[v], points[w]) > 0;
+        if (order(v, u) && order(v, w)) {
+            types[v] = convex ? START : SPLIT;
+        } else if (order(u, v) && order(w, v)) {
+            types[v] = convex ? END : MERGE;
+        } else {
+            types[v] = REGULAR;
+        }
+    }
+    std::sort(sweep.begin(), sweep.end(), order);
+
+    // the lowest vertex seen so far that an edge's next diagonal may go to
+    std::vector<uint32_t> helpers(n);
+    std::set<uint32_t, EdgeOrder> status(EdgeOrder {&rings});
+    std::vector<std::pair<uint32_t, uint32_t>> diagonals;
+
+    // the edge directly left of vertex v
+    auto left_of = [&](const uint32_t v) {
+        auto it = status.lower_bound(EdgeOrder::Probe {v});
+        return it == status.begin() ? NIL : *std::prev(it);
+    };
+    // ends edge e at v, connecting a merge vertex left waiting above
+    auto finish = [&](const uint32_t e, const uint32_t v) {
+        if (types[helpers[e]] == MERGE) diagonals.emplace_back(v, helpers[e]);
+        status.erase(e);
+    };
+    auto pass = [&](const uint32_t e, const uint32_t v) {
+        if (e == NIL) return;
+        if (types[helpers[e]] == MERGE) diagonals.emplace_back(v, helpers[e]);
+        helpers[e] = v;
+    };
+
+    for (uint32_t v : sweep) {
+        uint32_t u = rings.prev[v];
+        switch (types[v]) {
+            case START:
+                helpers[v] = v;
+                status.insert(v);
+                break;
+            case END:
+                finish(u, v);
+                break;
+            case SPLIT: {
+                uint32_t e = left_of(v);
+                if (e != NIL) {
+                    diagonals.emplace_back(v, helpers[e]);
+                    helpers[e] = v;
+                }
+                helpers[v] = v;
+                status.insert(v);
+                break;
+            }
+            case MERGE:
+                finish(u, v);
+                pass(left_of(v), v);
+                break;
+            case REGULAR:
+                if (order(u, v)) {
+                    // the interior is to the right, so v ends one left boundary edge and starts the next
+                    finish(u, v);
+                    helpers[v] = v;
+                    status.insert(v);
+                } else {
+                    pass(left_of(v), v);
+                }
+                break;
+        }
+    }
+    return diagonals;
+}
+
+/*
+ * Triangulates a piece monotone in the sweep order, given as its
+ * vertices in counterclockwise order, with the usual stack of
+ * vertices still waiting for a triangle (de Berg et al. 3.3).
+ * A vertex on a straight line between its neighbors on the stack
+ * waits until a vertex of the other chain reaches it, so no
+ * triangle is flat unless the piece itself is.
+ */
+void triangulate_monotone(const std::vector<Point>& points, const std::vector<uint32_t>& piece,
+                          std::vector<Triangle>& triangles) {
+    SweepOrder order = {&points};
+    size_t size = piece.size();
+    size_t top = 0, bottom = 0;
+    for (size_t k = 1; k < size; k++) {
+        if (order(piece[k], piece[top])) top = k;
+        if (order(piece[bottom], piece[k])) bottom = k;
+    }
+
+    // counterclockwise from the top runs down the left chain, clockwise down the right one
+    std::vector<std::pair<uint32_t, bool>> sorted;
+    sorted.reserve(size);
+    sorted.emplace_back(piece[top], true);
+    size_t left = (top + 1) % size, right = (top + size - 1) % size;
+    while (left != bottom || right != bottom) {
+        if (right == bottom || (left != bottom && order(piece[left], piece[right]))) {
+            sorted.emplace_back(piece[left], true);
+            left = (left + 1) % size;
+        } else {
+            sorted.emplace_back(piece[right], false);
+            right = (right + size - 1) % size;
+        }
+    }
+    sorted.emplace_back(piece[bottom], true);
+
+    auto add = [&](const uint32_t a, const uint32_t b, const uint32_t c) {
+        if (turn(points[a], points[b], points[c]) < 0) {
+            triangles.push_back((Triangle) {{a, c, b}, {NO_NEIGHBOR, NO_NEIGHBOR, NO_NEIGHBOR}});
+        } else {
+            triangles.push_back((Triangle) {{a, b, c}, {NO_NEIGHBOR, NO_NEIGHBOR, NO_NEIGHBOR}});
+        }
+    };
+    // joins v to every vertex on the stack, which is left with its top and v
+    auto fan = [&](std::vector<std::pair<uint32_t, bool>>& stack, const std::pair<uint32_t, bool>& v) {
+        std::pair<uint32_t, bool> top_vertex = stack.back();
+        for (size_t k = stack.size() - 1; k > 0; k--) add(v.first, stack[k].first, stack[k - 1].first);
+        stack.assign({top_vertex, v});
+    };
+
+    std::vector<std::pair<uint32_t, bool>> stack = {sorted[0], sorted[1]};
+    for (size_t k = 2; k + 1 < sorted.size(); k++) {
+        const std::pair<uint32_t, bool>& v = sorted[k];
+        if (v.second != stack.back().second) {
+            fan(stack, v);
+            continue;
+        }
+        std::pair<uint32_t, bool> last = stack.back();
+        stack.pop_back();
+        while (!stack.empty()) {
+            const Point& p = points[stack.back().first];
+            const Point& q = points[last.first];
+            const Point& r = points[v.first];
+            // the chain turns toward the interior at last, so v sees the vertex below last on the stack
+            if ((v.second ? turn(p, q, r) : turn(r, q, p)) <= 0) break;
+            add(v.first, last.first, stack.back().first);
+            last = stack.back();
+            stack.pop_back();
+        }
+        stack.push_back(last);
+        stack.push_back(v);
+    }
+    fan(stack, sorted.back());
+}
+
+/*
+ * The pieces the polygon edges and diagonals cut the interior
+ * into, each as its vertices in counterclockwise order
+ */
+std::vector<std::vector<uint32_t>> monotone_pieces(
+        const Rings& rings,
+        const std::vector<std::pair<uint32_t, uint32_t>>& diagonals) {
+
+    // half edges: polygon edge v runs from v to rings.next[v], diagonal d both ways as n + 2d and n + 2d + 1
+    uint32_t n = (uint32_t) rings.points.size();
+    uint32_t half_edge_count = n + 2 * (uint32_t) diagonals.size();
+    std::vector<uint32_t> from(half_edge_count), to(half_edge_count);
+    for (uint32_t v = 0; v < n; v++) {
+        from[v] = v;
+        to[v] = rings.next[v];
+    }
+    for (uint32_t d = 0; d < diagonals.size(); d++) {
+        from[n + 2 * d] = to[n + 2 * d + 1] = diagonals[d].first;
+        to[n + 2 * d] = from[n + 2 * d + 1] = diagonals[d].second;
+    }
+
+    // the half edges leaving each vertex, grouped by vertex
+    std::vector<uint32_t> first_out(n + 1, 0), out(half_edge_count);
+    for (uint32_t h = 0; h < half_edge_count; h++) first_out[from[h] + 1]++;
+    for (uint32_t v = 0; v < n; v++) first_out[v + 1] += first_out[v];
+    std::vector<uint32_t> fill(first_out.begin(), first_out.end() - 1);
+    for (uint32_t h = 0; h < half_edge_count; h++) out[fill[from[h]]++] = h;
+
+    auto angle = [&](const uint32_t a, const uint32_t b) {
+        return atan2(rings.points[b].y - rings.points[a].y, rings.points[b].x - rings.points[a].x);
+    };
+
+    // the piece to the left of a half edge continues along the first half edge clockwise from its reverse
+    std::vector<uint32_t> next(half_edge_count);
+    for (uint32_t h = 0; h < half_edge_count; h++) {
+        uint32_t v = to[h];
+        double back = angle(v, from[h]), best = INFINITY;
+        for (uint32_t k = first_out[v]; k < first_out[v + 1]; k++) {
+            uint32_t g = out[k];
+            if (to[g] == from[h]) continue;
+            double clockwise = back - angle(v, to[g]);
+            if (clockwise <= 0) clockwise += 2 * M_PI;
+            if (clockwise < best) {
+                best = clockwise;
+                next[h] = g;
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> pieces;
+    std::vector<bool> used(half_edge_count, false);
+    for (uint32_t h = 0; h < half_edge_count; h++) {
+        if (used[h]) continue;
+        pieces.emplace_back();
+        for (uint32_t g = h; !used[g]; g = next[g]) {
+            used[g] = true;
+            pieces.back().push_back(from[g]);
+        }
+    }
+    return pieces;
+}
+
+// positive if d is inside the circle through a, b, c (counterclockwise), with a bound on its rounding error
+double in_circle(const Point& a, const Point& b, const Point& c, const Point& d, double& error_bound) {
+    double adx = a.x - d.x, ady = a.y - d.y;
+    double bdx = b.x - d.x, bdy = b.y - d.y;
+    double cdx = c.x - d.x, cdy = c.y - d.y;
+    double a_lift = adx * adx + ady * ady;
+    double b_lift = bdx * bdx + bdy * bdy;
+    double c_lift = cdx * cdx + cdy * cdy;
+    error_bound = 1e-10 * (a_lift * (fabs(bdx * cdy) + fabs(cdx * bdy)) +
+                           b_lift * (fabs(cdx * ady) + fabs(adx * cdy)) +
+                           c_lift * (fabs(adx * bdy) + fabs(bdx * ady)));
+    return a_lift * (bdx * cdy - cdx * bdy) + b_lift * (cdx * ady - adx * cdy) + c_lift * (adx * bdy - bdx * ady);
+}
+
+/*
+ * Fills in the neighbors of triangles by matching up the two
+ * sides of every edge
+ */
+void link_neighbors(std::vector<Triangle>& triangles) {
+    struct HalfEdge {
+        uint32_t low;
+        uint32_t high;
+        uint32_t triangle;
+        uint32_t k;
+    };
+    std::vector<HalfEdge> half_edges;
+    half_edges.reserve(3 * triangles.size());
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        for (uint32_t k = 0; k < 3; k++) {
+            uint32_t u = triangles[t].vertices[k], v = triangles[t].vertices[(k + 1) % 3];
+            half_edges.push_back((HalfEdge) {std::min(u, v), std::max(u, v), t, k});
+            triangles[t].neighbors[k] = NO_NEIGHBOR;
+        }
+    }
+    std::sort(half_edges.begin(), half_edges.end(), [](const HalfEdge& e1, const HalfEdge& e2) {
+        if (e1.low != e2.low) return e1.low < e2.low;
+        return e1.high < e2.high;
+    });
+    for (size_t k = 0; k + 1 < half_edges.size(); k++) {
+        const HalfEdge& e1 = half_edges[k];
+        const HalfEdge& e2 = half_edges[k + 1];
+        if (e1.low != e2.low || e1.high != e2.high) continue;
+        triangles[e1.triangle].neighbors[e1.k] = e2.triangle;
+        triangles[e2.triangle].neighbors[e2.k] = e1.triangle;
+        k++;
+    }
+}
+
+// the k for which neighbors[k] of triangle is other
+uint32_t neighbor_side(const Triangle& triangle, const uint32_t other) {
+    for (uint32_t k = 0; k < 3; k++) {
+        if (triangle.neighbors[k] == other) return k;
+    }
+    return 3;
+}
+
+/*
+ * Lawson's flips: an edge shared by two triangles is replaced by
+ * the other diagonal of their quadrilateral while the opposite
+ * vertex lies inside the circumcircle of a triangle. Polygon
+ * edges have no neighbor, so they are never flipped.
+ */
+void make_delaunay(const std::vector<Point>& points, std::vector<Triangle>& triangles) {
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        for (uint32_t k = 0; k < 3; k++) {
+            if (triangles[t].neighbors[k] != NO_NEIGHBOR && triangles[t].neighbors[k] > t) stack.emplace_back(t, k);
+        }
+    }
+
+    while (!stack.empty()) {
+        uint32_t t = stack.back().first, k = stack.back().second;
+        stack.pop_back();
+        uint32_t u = triangles[t].neighbors[k];
+        if (u == NO_NEIGHBOR) continue;
+        uint32_t m = neighbor_side(triangles[u], t);
+        if (m == 3) continue;
+
+        // t = (a, b, c) and u = (b, a, d) share the edge a-b
+        uint32_t a = triangles[t].vertices[k];
+        uint32_t b = triangles[t].vertices[(k + 1) % 3];
+        uint32_t c = triangles[t].vertices[(k + 2) % 3];
+        uint32_t d = triangles[u].vertices[(m + 2) % 3];
+        if (c == d) continue;
+
+        double error_bound;
+        if (in_circle(points[a], points[b], points[c], points[d], error_bound) <= error_bound) continue;
+        if (turn(points[c], points[a], points[d]) <= 0 || turn(points[d], points[b], points[c]) <= 0) continue;
+
+        uint32_t t_bc = triangles[t].neighbors[(k + 1) % 3];
+        uint32_t t_ca = triangles[t].neighbors[(k + 2) % 3];
+        uint32_t u_ad = triangles[u].neighbors[(m + 1) % 3];
+        uint32_t u_db = triangles[u].neighbors[(m + 2) % 3];
+
+        // t becomes (c, a, d) and u becomes (d, b, c)
+        triangles[t] = (Triangle) {{c, a, d}, {t_ca, u_ad, u}};
+        triangles[u] = (Triangle) {{d, b, c}, {u_db, t_bc, t}};
+        if (u_ad != NO_NEIGHBOR) triangles[u_ad].neighbors[neighbor_side(triangles[u_ad], u)] = t;
+        if (t_bc != NO_NEIGHBOR) triangles[t_bc].neighbors[neighbor_side(triangles[t_bc], t)] = u;
+
+        stack.emplace_back(t, 0);
+        stack.emplace_back(t, 1);
+        stack.emplace_back(u, 0);
+        stack.emplace_back(u, 1);
+    }
+}
+
+std::vector<Triangle> triangulate(const std::vector<std::vector<Point>>& polygon) {
+    Rings rings = link_rings(polygon);
+    std::vector<Triangle> triangles;
+    if (rings.points.size() < 3) return triangles;
+    triangles.reserve(rings.points.size() + 2 * polygon.size());
+
+    std::vector<std::vector<uint32_t>> pieces = monotone_pieces(rings, monotone_diagonals(rings));
+    for (size_t k = 0; k < pieces.size(); k++) triangulate_monotone(rings.points, pieces[k], triangles);
+
+    link_neighbors(triangles);
+    make_delaunay(rings.points, triangles);
+
+    // number the vertices as graph nodes
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (size_t k = 0; k < 3; k++) triangles[t].vertices[k] += 2;
+    }
+    return triangles;
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "triangulation_index.hpp"
+#include "parallel.hpp"
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+// upper bound on the cells along either side of the locate grid
+const size_t MAX_LOCATE_GRID_SIDE = 4096;
+
+// how near, as a fraction of an edge's length, a ray can pass to the end of the edge before it is taken to hit it
+const double PROJECT_TOLERANCE = 10e-12;
+
+TriangulationIndex::TriangulationIndex(const std::vector<std::vector<Point>>& polygon) :
+        triangles(triangulate(polygon)), point_locator(polygon) {
+    origin = {__DBL_MAX__, __DBL_MAX__};
+    corner = {-__DBL_MAX__, -__DBL_MAX__};
+    for (size_t i = 0; i < polygon.size(); i++) {
+        vertices.insert(vertices.end(), polygon[i].begin(), polygon[i].end());
+
+        // a path can only bend around a vertex where the polygon is not convex
+        double twice_area = 0;
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            const Point& p = polygon[i][j];
+            const Point& q = polygon[i][(j + 1) % polygon[i].size()];
+            twice_area += p.x * q.y - q.x * p.y;
+        }
+        Orientation convex = (i == 0) == (twice_area > 0) ? COUNTERCLOCKWISE : CLOCKWISE;
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            const Point& before = polygon[i][(j + polygon[i].size() - 1) % polygon[i].size()];
+            const Point& after = polygon[i][(j + 1) % polygon[i].size()];
+            corners.push_back(orientation(before, polygon[i][j], after) != convex);
+        }
+
+        for (size_t j = 0; j < polygon[i].size(); j++) {
+            origin.x = fmin(origin.x, polygon[i][j].x);
+            origin.y = fmin(origin.y, polygon[i][j].y);
+            corner.x = fmax(corner.x, polygon[i][j].x);
+            corner.y = fmax(corner.y, polygon[i][j].y);
+        }
+    }
+
+    // aim for about one cell per triangle, as EdgeGrid does per edge
+    double width = fmax(corner.x - origin.x, 0), height = fmax(corner.y - origin.y, 0);
+    double triangle_count = triangles.empty() ? 1 : (double) triangles.size();
+    if (width > 0 && height > 0) {
+        cell_size = sqrt(width * height / triangle_count);
+    } else {
+        cell_size = fmax(width, height) / triangle_count;
+    }
+    if (!(cell_size > 0)) cell_size = 1;
+    cell_size = fmax(cell_size, fmax(width, height) / MAX_LOCATE_GRID_SIDE);
+    columns = std::min((size_t) (width / cell_size) + 1, MAX_LOCATE_GRID_SIDE);
+    rows = std::min((size_t) (height / cell_size) + 1, MAX_LOCATE_GRID_SIDE);
+
+    // bucket the triangles by cell: count, prefix sum, then fill
+    auto visit_cells = [&](const Triangle& triangle, const std::function<void(size_t)>& visit) {
+        const Point& a = vertex(triangle.vertices[0]);
+        const Point& b = vertex(triangle.vertices[1]);
+        const Point& c = vertex(triangle.vertices[2]);
+        size_t column_hi = cell_column(fmax(a.x, fmax(b.x, c.x)));
+        size_t row_hi = cell_row(fmax(a.y, fmax(b.y, c.y)));
+        for (size_t row = cell_row(fmin(a.y, fmin(b.y, c.y))); row <= row_hi; row++) {
+            for (size_t column = cell_column(fmin(a.x, fmin(b.x, c.x))); column <= column_hi; column++) {
+                visit(row * columns + column);
+            }
+        }
+    };
+    cell_offsets.assign(columns * rows + 1, 0);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        visit_cells(triangles[t], [&](size_t cell) { cell_offsets[cell + 1]++; });
+    }
+    for (size_t cell = 0; cell < columns * rows; cell++) {
+        cell_offsets[cell + 1] += cell_offsets[cell];
+    }
+    std::vector<uint32_t> fill(cell_offsets.begin(), cell_offsets.end() - 1);
+    cell_triangles.resize(cell_offsets.back());
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        visit_cells(triangles[t], [&](size_t cell) { cell_triangles[fill[cell]++] = t; });
+    }
+}
+
+const Point& TriangulationIndex::vertex(const uint32_t idx) const {
+    return vertices[idx - 2];
+}
+
+size_t TriangulationIndex::cell_column(const double x) const {
+    double column = floor((x - origin.x) / cell_size);
+    if (!(column > 0)) return 0;
+    return column >= columns - 1 ? columns - 1 : (size_t) column;
+}
+
+size_t TriangulationIndex::cell_row(const double y) const {
+    double row = floor((y - origin.y) / cell_size);
+    if (!(row > 0)) return 0;
+    return row >= rows - 1 ? rows - 1 : (size_t) row;
+}
+
+const std::vector<Triangle>& TriangulationIndex::get_triangles() const {
+    return triangles;
+}
+
+uint32_t TriangulationIndex::locate(const Point& point) const {
+    // the tolerance orientation allows points on an edge
+    double margin = cell_size * 10e-10;
+    if (point.x < origin.x - margin || point.x > corner.x + margin ||
+        point.y < origin.y - margin || point.y > corner.y + margin) {
+        return NO_NEIGHBOR;
+    }
+
+    size_t cell = cell_row(point.y) * columns + cell_column(point.x);
+    for (uint32_t k = cell_offsets[cell]; k < cell_offsets[cell + 1]; k++) {
+        uint32_t t = cell_triangles[k];
+        const Point& a = vertex(triangles[t].vertices[0]);
+        const Point& b = vertex(triangles[t].vertices[1]);
+        const Point& c = vertex(triangles[t].vertices[2]);
+
+        // counterclockwise, so the point is inside if it is on no edge's clockwise side
+        if (orientation(a, b, point) != CLOCKWISE &&
+            orientation(b, c, point) != CLOCKWISE &&
+            orientation(c, a, point) != CLOCKWISE) {
+            return t;
+        }
+    }
+    return NO_NEIGHBOR;
+}
+
+void TriangulationIndex::containing_triangles(
+        const Point& point,
+        const uint32_t t,
+        std::vector<uint32_t>& found) const {
+
+    // a point on an edge is in the triangles on both sides, and a vertex in every triangle around it
+    found.assign(1, t);
+    for (size_t k = 0; k < found.size(); k++) {
+        const Triangle& triangle = triangles[found[k]];
+        for (size_t side = 0; side < 3; side++) {
+            uint32_t neighbor = triangle.neighbors[side];
+            if (neighbor == NO_NEIGHBOR || std::find(found.begin(), found.end(), neighbor) != found.end()) continue;
+            const Point& a = vertex(triangle.vertices[side]);
+            const Point& b = vertex(triangle.vertices[(side + 1) % 3]);
+            if (orientation(a, b, point) == COLINEAR && on_segment((Segment) {a, b}, point)) found.push_back(neighbor);
+        }
+    }
+}
+
+double TriangulationIndex::project(
+        const Point& root,
+        const Point& through,
+        const uint32_t through_vertex,
+        const uint32_t t,
+        const uint32_t side) const {
+
+    const Triangle& triangle = triangles[t];
+    const Point& a = vertex(triangle.vertices[side]);
+    const Point& b = vertex(triangle.vertices[(side + 1) % 3]);
+    const Point& c = vertex(triangle.vertices[(side + 2) % 3]);
+    Point d = {through.x - root.x, through.y - root.y};
+
+    // the ray leaves through the edge from c to a if c is to its right, else through the edge from b to c
+    Orientation c_side = orientation(root, through, c);
+    if (c_side == COLINEAR) return 1;
+    if (c_side == CLOCKWISE && through_vertex == triangle.vertices[side]) return 0;
+    if (c_side == COUNTERCLOCKWISE && through_vertex == triangle.vertices[(side + 1) % 3]) return 2;
+    const Point& from = c_side == CLOCKWISE ? a : c;
+    const Point& to = c_side == CLOCKWISE ? c : b;
+    double denominator = d.x * (to.y - from.y) - d.y * (to.x - from.x);
+    if (denominator == 0) return 1;
+    double u = (d.x * (root.y - from.y) - d.y * (root.x - from.x)) / denominator;
+
+    // a ray passing within rounding of a vertex passes through it
+    if (u < PROJECT_TOLERANCE) u = 0;
+    if (u > 1 - PROJECT_TOLERANCE) u = 1;
+    return c_side == CLOCKWISE ? u : 1 + u;
+}
+
+DijkstraData TriangulationIndex::dijkstra_path(
+        const Point& start,
+        const Point& end,
+        const QueryOptions& options) const {
+
+    QueryContext context;
+    dijkstra_path(start, end, context, options);
+    return std::move(context.result);
+}
+
+const DijkstraData& TriangulationIndex::dijkstra_path(
+        const Point& start_point,
+        const Point& end_point,
+        QueryContext& context,
+        const QueryOptions& options) const {
+
+    StatsScope stats_scope(options.stats);
+    Point start = start_point, end = end_point;
+    if (options.endpoints != TRUST_ENDPOINTS) {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        if (!point_locator.resolve(start, options.endpoints) || !point_locator.resolve(end, options.endpoints)) {
+            context.result.path.clear();
+            context.result.distance = __DBL_MAX__;
+            return context.result;
+        }
+    }
+
+    // the answer when there is no path, reusing the capacity of the last one
+    auto no_path = [&]() -> const DijkstraData& {
+        context.result.path.assign({start, end});
+        context.result.distance = __DBL_MAX__;
+        return context.result;
+    };
+
+    uint32_t start_triangle, end_triangle;
+    {
+        StatsTimer stats_timer(&QueryStats::build_seconds);
+        start_triangle = locate(start);
+        end_triangle = locate(end);
+    }
+    if (start_triangle == NO_NEIGHBOR || end_triangle == NO_NEIGHBOR) return no_path();
+
+    StatsTimer search_timer(&QueryStats::search_seconds);
+    if (!context.triangulation) context.triangulation.reset(new TriangulationScratch());
+    TriangulationScratch& scratch = *context.triangulation;
+    std::vector<uint32_t>& start_triangles = scratch.start_triangles;
+    std::vector<uint32_t>& end_triangles = scratch.end_triangles;
+    containing_triangles(start, start_triangle, start_triangles);
+    containing_triangles(end, end_triangle, end_triangles);
+    auto holds_end = [&](const uint32_t t) {
+        return std::find(end_triangles.begin(), end_triangles.end(), t) != end_triangles.end();
+    };
+
+    // a triangle is convex, so start sees end if they share one
+    for (uint32_t t : start_triangles) {
+        if (!holds_end(t)) continue;
+        context.result.path.assign({start, end});
+        context.result.distance = length((Segment) {start, end});
+        return context.result;
+    }
+
+    /*
+     * A* over intervals of triangle edges, each seen from a root
+     * (start, or a corner the path bends around), keyed by the
+     * length of the path to the root plus the shortest distance
+     * from the root through the interval to end. Expanding an
+     * interval looks into the triangle beyond it: the part of
+     * its other two edges seen from the root through the interval
+     * keeps the root, and the parts beyond either end of the
+     * interval, if that end is a corner, are seen from that
+     * corner instead. The first path to end popped is the
+     * shortest, as every path is a chain of such intervals.
+     */
+    std::vector<IntervalNode>& intervals = scratch.intervals;
+    intervals.clear();
+    std::vector<IntervalRoot>& roots = scratch.roots;
+    roots.assign(1, (IntervalRoot) {start, (uint32_t) START_IDX, NO_NEIGHBOR, 0});
+    std::vector<std::pair<double, uint32_t>>& interval_queue = scratch.interval_queue;
+    interval_queue.clear();
+    auto later = std::greater<std::pair<double, uint32_t>>();
+
+    // the shortest path found to each corner and its root, so the intervals of any other root there are dropped
+    std::vector<double>& root_distances = context.distances;
+    root_distances.assign(vertices.size() + 2, __DBL_MAX__);
+    std::vector<uint32_t>& root_entries = context.prev;
+    root_entries.assign(vertices.size() + 2, NO_NEIGHBOR);
+    root_distances[START_IDX] = 0;
+    root_entries[START_IDX] = 0;
+
+    /*
+     * Of paths as short (common in symmetric polygons), Dijkstra's
+     * search keeps the one through the node it settles first: the
+     * nearer to start, then the lower node index. Roots are ranked
+     * the same way, so the path found is the one dijkstra_path finds.
+     */
+    auto settles_before = [&](const uint32_t r1, const uint32_t r2) {
+        if (roots[r1].g != roots[r2].g) return roots[r1].g < roots[r2].g;
+        if (roots[r1].vertex != roots[r2].vertex) return roots[r1].vertex < roots[r2].vertex;
+        return root_entries[roots[r1].vertex] == r1;
+    };
+
+    // a lower bound on the path from the root of node through its interval to end
+    auto estimate = [&](const IntervalNode& node) {
+        // the g of a path to end is its whole length
+        if (node.triangle == NO_NEIGHBOR) return 0.0;
+        const Point& root = roots[node.root].point;
+        if (roots[node.root].vertex == node.left_vertex || roots[node.root].vertex == node.right_vertex) {
+            return length((Segment) {root, end});
+        }
+
+        // a path to an end on the root's side of the interval comes back across it, so reflect end
+        Point target = end;
+        double dx = node.right.x - node.left.x, dy = node.right.y - node.left.y;
+        if (orientation(node.left, node.right, end) == CLOCKWISE && dx * dx + dy * dy > 0) {
+            double s = ((end.x - node.left.x) * dx + (end.y - node.left.y) * dy) / (dx * dx + dy * dy);
+            Point foot = {node.left.x + s * dx, node.left.y + s * dy};
+            target = {2 * foot.x - end.x, 2 * foot.y - end.y};
+        }
+        if (orientation(root, target, node.left) == CLOCKWISE) {
+            return length((Segment) {root, node.left}) + length((Segment) {node.left, target});
+        }
+        if (orientation(root, target, node.right) == COUNTERCLOCKWISE) {
+            return length((Segment) {root, node.right}) + length((Segment) {node.right, target});
+        }
+        return length((Segment) {root, target});
+    };
+    auto push = [&](const IntervalNode& node) {
+        interval_queue.emplace_back(node.g + estimate(node), (uint32_t) intervals.size());
+        std::push_heap(interval_queue.begin(), interval_queue.end(), later);
+        intervals.push_back(node);
+        STATS_ADD(heap_pushes, 1);
+    };
+
+    // the root at corner idx of the point reached from root parent, or NO_NEIGHBOR if it was reached by a shorter path
+    auto add_root = [&](const uint32_t parent, const uint32_t idx, const double g) {
+        if (g > root_distances[idx]) return NO_NEIGHBOR;
+        if (g == root_distances[idx]) {
+            uint32_t entry = root_entries[idx];
+            if (roots[entry].parent == parent) return entry;
+            if (!settles_before(parent, roots[entry].parent)) return NO_NEIGHBOR;
+        }
+        root_distances[idx] = g;
+        root_entries[idx] = (uint32_t) roots.size();
+        roots.push_back({vertex(idx), idx, parent, g});
+        return (uint32_t) (roots.size() - 1);
+    };
+
+    // queues the part [t0, t1] of the far side of triangle t (see project) seen from root
+    auto push_far_side = [&](const uint32_t t, const uint32_t side, double t0, double t1,
+                             const uint32_t root, const double g) {
+        const Triangle& triangle = triangles[t];
+        uint32_t a = triangle.vertices[side];
+        uint32_t b = triangle.vertices[(side + 1) % 3];
+        uint32_t c = triangle.vertices[(side + 2) % 3];
+        auto point_at = [&](const double u) {
+            if (u <= 0) return vertex(a);
+            if (u == 1) return vertex(c);
+            if (u >= 2) return vertex(b);
+            const Point& from = u < 1 ? vertex(a) : vertex(c);
+            const Point& to = u < 1 ? vertex(c) : vertex(b);
+            double w = u < 1 ? u : u - 1;
+            return (Point) {from.x + w * (to.x - from.x), from.y + w * (to.y - from.y)};
+        };
+        auto vertex_at = [&](const double u) {
+            return u <= 0 ? a : u == 1 ? c : u >= 2 ? b : NO_NEIGHBOR;
+        };
+
+        // the edge from c to a holds [0, 1] and the edge from b to c [1, 2]
+        for (uint32_t edge = 0; edge < 2; edge++) {
+            double lo = std::max(t0, (double) edge), hi = std::min(t1, (double) edge + 1);
+            if (!(lo < hi)) continue;
+            uint32_t edge_side = edge == 0 ? (side + 2) % 3 : (side + 1) % 3;
+            uint32_t neighbor = triangle.neighbors[edge_side];
+            if (neighbor == NO_NEIGHBOR) continue;
+            uint32_t neighbor_side = 0;
+            while (triangles[neighbor].neighbors[neighbor_side] != t) neighbor_side++;
+            push((IntervalNode) {point_at(lo), point_at(hi), vertex_at(lo), vertex_at(hi),
+                                 neighbor, neighbor_side, root, g});
+        }
+    };
+
+    for (uint32_t t : start_triangles) {
+        const Triangle& triangle = triangles[t];
+        for (uint32_t side = 0; side < 3; side++) {
+            uint32_t a = triangle.vertices[side];
+            uint32_t b = triangle.vertices[(side + 1) % 3];
+            uint32_t neighbor = triangle.neighbors[side];
+            if (neighbor == NO_NEIGHBOR || std::find(start_triangles.begin(), start_triangles.end(), neighbor) !=
+                                           start_triangles.end()) {
+                continue;
+            }
+            uint32_t neighbor_side = 0;
+            while (triangles[neighbor].neighbors[neighbor_side] != t) neighbor_side++;
+            push((IntervalNode) {vertex(b), vertex(a), b, a, neighbor, neighbor_side, 0, 0});
+        }
+    }
+
+    uint32_t last_root = NO_NEIGHBOR;
+    double distance = __DBL_MAX__;
+    // the first path to end popped is the shortest, but any as short still queued may be the one to keep
+    while (!interval_queue.empty() && !(interval_queue.front().first > distance)) {
+        std::pop_heap(interval_queue.begin(), interval_queue.end(), later);
+        IntervalNode node = intervals[interval_queue.back().second];
+        interval_queue.pop_back();
+        STATS_ADD(heap_pops, 1);
+        uint32_t root_vertex = roots[node.root].vertex;
+        if (root_entries[root_vertex] != node.root) continue;
+        if (node.triangle == NO_NEIGHBOR) {
+            if (last_root == NO_NEIGHBOR || settles_before(node.root, last_root)) {
+                last_root = node.root;
+                distance = node.g;
+            }
+            continue;
+        }
+        STATS_ADD(nodes_settled, 1);
+
+        // copied, as adding a root may move roots
+        Point root = roots[node.root].point;
+
+        // where the rays from the root through either end of the interval leave the triangle
+        double left_t = root_vertex == node.left_vertex ? 1 :
+                        project(root, node.left, node.left_vertex, node.triangle, node.side);
+        double right_t = root_vertex == node.right_vertex ? 1 :
+                         project(root, node.right, node.right_vertex, node.triangle, node.side);
+        right_t = std::max(left_t, right_t);
+        bool left_corner = node.left_vertex != NO_NEIGHBOR && corners[node.left_vertex - 2];
+        bool right_corner = node.right_vertex != NO_NEIGHBOR && corners[node.right_vertex - 2];
+
+        if (holds_end(node.triangle)) {
+            // end is in a triangle, so it is seen from the root or from the end of the interval it is beyond
+            IntervalNode to_end = node;
+            to_end.triangle = NO_NEIGHBOR;
+            if (root_vertex != node.left_vertex && orientation(root, node.left, end) == COUNTERCLOCKWISE) {
+                to_end.root = left_corner ? add_root(node.root, node.left_vertex,
+                                                     node.g + length((Segment) {root, node.left})) : NO_NEIGHBOR;
+            } else if (root_vertex != node.right_vertex && orientation(root, node.right, end) == CLOCKWISE) {
+                to_end.root = right_corner ? add_root(node.root, node.right_vertex,
+                                                      node.g + length((Segment) {root, node.right})) : NO_NEIGHBOR;
+            }
+            if (to_end.root != NO_NEIGHBOR) {
+                const IntervalRoot& end_root = roots[to_end.root];
+                to_end.g = end_root.g + length((Segment) {end_root.point, end});
+                push(to_end);
+            }
+        }
+
+        push_far_side(node.triangle, node.side, left_t, right_t, node.root, node.g);
+
+        // beyond a corner at either end, the rest of the far side is seen from the corner
+        // (or, if the root is that end, the rest of the triangle around it)
+        if (left_corner && left_t > 0) {
+            double g = root_vertex == node.left_vertex ? node.g : node.g + length((Segment) {root, node.left});
+            uint32_t corner = root_vertex == node.left_vertex ? node.root : add_root(node.root, node.left_vertex, g);
+            if (corner != NO_NEIGHBOR) push_far_side(node.triangle, node.side, 0, left_t, corner, g);
+        }
+        if (right_corner && right_t < 2) {
+            double g = root_vertex == node.right_vertex ? node.g : node.g + length((Segment) {root, node.right});
+            uint32_t corner = root_vertex == node.right_vertex ? node.root : add_root(node.root, node.right_vertex, g);
+            if (corner != NO_NEIGHBOR) push_far_side(node.triangle, node.side, right_t, 2, corner, g);
+        }
+    }
+
+    search_timer.stop();
+    if (last_root == NO_NEIGHBOR) return no_path();
+    StatsTimer reconstruction_timer(&QueryStats::reconstruction_seconds);
+
+    std::vector<Point>& path = context.result.path;
+    path.assign(1, end);
+    for (uint32_t r = last_root; r != NO_NEIGHBOR; r = roots[r].parent) path.push_back(roots[r].point);
+    std::reverse(path.begin(), path.end());
+    context.result.distance = distance;
+    return context.result;
+}
+
+std::vector<DijkstraData> TriangulationIndex::dijkstra_paths(
+        const std::vector<std::pair<Point, Point>>& queries,
+        const size_t threads,
+        const QueryOptions& options) const {
+
+    // the workers count into stats of their own, added to options.stats once they are done
+    StatsScope stats_scope(options.stats);
+    QueryOptions worker_options = options;
+    worker_options.stats = nullptr;
+
+    std::vector<DijkstraData> results(queries.size());
+    // one context per worker, reused for every query it runs
+    std::vector<QueryContext> contexts(worker_count(threads));
+    parallel_for(queries.size(), threads, 1, [&](size_t worker, size_t idx) {
+        results[idx] = dijkstra_path(queries[idx].first, queries[idx].second, contexts[worker], worker_options);
+    });
+    return results;
+}
+
+} // namespace bfreeman
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include "visibility_sweep.hpp"
+#include "polygon_geometry.hpp"
+#include "query_stats.hpp"
+
+namespace bfreeman {
+
+// the ray being swept around a vertex
+struct SweepRay {
+    Point origin;
+    Point direction;
+};
+
+/*
+ * Orders the edges crossed by the sweep ray by how far along
+ * the ray they are crossed, in units of the ray direction
+ */
+struct SweepEdgeOrder {
+    const SweepRay* ray;
+    const std::vector<Point>* points;
+    const std::vector<size_t>* next;
+
+    double distance(const size_t e) const {
+        const Point& a = (*points)[e];
+        const Point& b = (*points)[(*next)[e]];
+        const Point& o = ray->origin;
+        const Point& d = ray->direction;
+        double denominator = d.x * (b.y - a.y) - d.y * (b.x - a.x);
+        if (denominator == 0) {
+            // parallel to the ray: use the nearer endpoint
+            double da = (a.x - o.x) * d.x + (a.y - o.y) * d.y;
+            double db = (b.x - o.x) * d.x + (b.y - o.y) * d.y;
+            return fmin(da, db) / (d.x * d.x + d.y * d.y);
+        }
+        return ((a.x - o.x) * (b.y - a.y) - (a.y - o.y) * (b.x - a.x)) / denominator;
+    }
+
+    /*
+     * @return the angle at shared between the directions
+     *         to the ray origin and to other
+     */
+    double angle_from_origin(const size_t shared, const size_t other) const {
+        const Point& s = (*points)[shared];
+        const Point& t = (*points)[other];
+        const Point& o = ray->origin;
+        double to_origin_x = o.x - s.x, to_origin_y = o.y - s.y;
+        double to_other_x = t.x - s.x, to_other_y = t.y - s.y;
+        return atan2(fabs(to_origin_x * to_other_y - to_origin_y * to_other_x),
+                     to_origin_x * to_other_x + to_origin_y * to_other_y);
+    }
+
+    bool operator()(const size_t e1, const size_t e2) const {
+        if (e1 == e2) return false;
+        double d1 = distance(e1);
+        double d2 = distance(e2);
+        if (fabs(d1 - d2) > 10e-13 * fmax(1.0, fabs(d1))) return d1 < d2;
+
+        // crossed at the same point: the edges meet there, and the
+        // one bending back toward the origin is the nearer one
+        size_t e1_end = (*next)[e1], e2_end = (*next)[e2];
+        size_t shared = SIZE_MAX;
+        if (e1 == e2_end) shared = e1;
+        if (e1_end == e2) shared = e1_end;
+        if (shared != SIZE_MAX) {
+            double a1 = angle_from_origin(shared, shared == e1 ? e1_end : e1);
+            double a2 = angle_from_origin(shared, shared == e2 ? e2_end : e2);
+            if (a1 != a2) return a1 < a2;
+        } else if (d1 != d2) {
+            return d1 < d2;
+        }
+        return e1 < e2;
+    }
+};
+
+VisibilitySweep::VisibilitySweep(
+        const std::vector<std::vector<Point>>& polygon,
+        const EdgeGrid& edge_grid) : polygon(polygon), edge_grid(edge_grid) {
+
+    min_edge_length = __DBL_MAX__;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        size_t first = points.size();
+        size_t size = polygon[i].size();
+        ring_offsets.push_back(first);
+        for (size_t j = 0; j < size; j++) {
+            points.push_back(polygon[i][j]);
+            idxps.emplace_back(i, j);
+            next.push_back(first + (j + 1) % size);
+            prev.push_back(first + (j + size - 1) % size);
+            min_edge_length = fmin(min_edge_length, length((Segment) {polygon[i][j], polygon[i][(j + 1) % size]}));
+        }
+    }
+    cones = get_vertex_cones(polygon);
+}
+
+void VisibilitySweep::populate_row(std::vector<Edge>& adj_list_row, const IndexPair idxp) const {
+    size_t vertex_count = points.size();
+    size_t v = ring_offsets[idxp.i] + idxp.j;
+    Point origin = points[v];
+
+    // every other vertex, sorted by angle around v, then by distance
+    std::vector<double> angles(vertex_count);
+    std::vector<double> distances(vertex_count);
+    std::vector<size_t> order;
+    double nearest = __DBL_MAX__;
+    for (size_t w = 0; w < vertex_count; w++) {
+        if (w == v) continue;
+        double dx = points[w].x - origin.x;
+        double dy = points[w].y - origin.y;
+        angles[w] = atan2(dy, dx);
+        if (angles[w] < 0) angles[w] += 2 * M_PI;
+        distances[w] = sqrt(sq(dx) + sq(dy));
+        nearest = fmin(nearest, distances[w]);
+        order.push_back(w);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t w1, size_t w2) {
+        if (angles[w1] != angles[w2]) return angles[w1] < angles[w2];
+        return distances[w1] < distances[w2];
+    });
+
+    /*
+     * @return true if another vertex lies on (or within the
+     *         tolerance of orientation of) the ray through order[k],
+     *         in which case the sweep order there is ambiguous
+     */
+    auto lines_up = [&](const size_t k) {
+        size_t w = order[k];
+        double window = 2 * ORIENTATION_EPSILON / (distances[w] * nearest);
+        for (int step = -1; step <= 1; step += 2) {
+            for (size_t n = 1; n < order.size(); n++) {
+                size_t x = order[(k + order.size() + step * n) % order.size()];
+                double difference = fabs(angles[w] - angles[x]);
+                difference = fmin(difference, 2 * M_PI - difference);
+                if (difference > window) break;
+                bool in_front = (points[w].x - origin.x) * (points[x].x - origin.x) +
+                                (points[w].y - origin.y) * (points[x].y - origin.y) > 0;
+                if (in_front && orientation(origin, points[w], points[x]) == COLINEAR) return true;
+            }
+        }
+        return false;
+    };
+
+    SweepRay ray = {origin, {1, 0}};
+    SweepEdgeOrder edge_order = {&ray, &points, &next};
+    std::set<size_t, SweepEdgeOrder> crossed(edge_order);
+    std::vector<std::set<size_t, SweepEdgeOrder>::iterator> handles(vertex_count);
+    std::vector<bool> active(vertex_count);
+
+    // edge e runs from e to next[e]; the edges at v never block a chord from v
+    auto touches_v = [&](const size_t e) {
+        return e == v || next[e] == v;
+    };
+
+    // start with the edges crossing the ray pointing along the positive x-axis
+    for (size_t e = 0; e < vertex_count; e++) {
+        if (touches_v(e)) continue;
+        const Point& a = points[e];
+        const Point& b = points[next[e]];
+        if ((a.y > origin.y) == (b.y > origin.y)) continue;
+        if (a.x + (origin.y - a.y) * (b.x - a.x) / (b.y - a.y) <= origin.x) continue;
+        handles[e] = crossed.insert(e).first;
+        active[e] = true;
+    }
+
+    auto blocked = [&](const Segment& chord) {
+        // how far past the vertex an edge check_intersect still counts can be crossed
+        double chord_length = length(chord);
+        double margin = 2 * ORIENTATION_EPSILON / fmin(chord_length, min_edge_length) / chord_length;
+        for (auto it = crossed.begin(); it != crossed.end(); ++it) {
+            Segment edge = {points[*it], points[next[*it]]};
+            if (check_intersect(chord, edge)) return true;
+            if (edge_order.distance(*it) > 1 + margin) return false;
+        }
+        return false;
+    };
+
+    std::vector<bool> visible(vertex_count);
+
+    for (size_t k = 0; k < order.size(); k++) {
+        size_t w = order[k];
+        ray.direction = {points[w].x - origin.x, points[w].y - origin.y};
+
+        Segment chord = {origin, points[w]};
+        if (pointing_inside(cones[v], points[w])) {
+            if (lines_up(k)) {
+                visible[w] = is_interior_chord_start_or_end(edge_grid, chord);
+            } else {
+                visible[w] = count_chord(!blocked(chord));
+            }
+        } else {
+            count_chord(false);
+        }
+
+        // the edges at w end once the ray has passed them and start if they lie ahead
+        size_t edges_at_w[2] = {prev[w], w};
+        double sides[2];
+        for (size_t i = 0; i < 2; i++) {
+            size_t e = edges_at_w[i];
+            const Point& other = points[e == w ? next[w] : e];
+            sides[i] = ray.direction.x * (other.y - points[w].y) - ray.direction.y * (other.x - points[w].x);
+            if (!touches_v(e) && sides[i] < 0 && active[e]) {
+                crossed.erase(handles[e]);
+                active[e] = false;
+            }
+        }
+        for (size_t i = 0; i < 2; i++) {
+            size_t e = edges_at_w[i];
+            if (!touches_v(e) && sides[i] > 0 && !active[e]) {
+                handles[e] = crossed.insert(e).first;
+                active[e] = true;
+            }
+        }
+    }
+
+    for (size_t w = 0; w < vertex_count; w++) {
+        if (w == v) continue;
+        bool neighbors = w == next[v] || w == prev[v];
+        if (neighbors || visible[w]) {
+            adj_list_row.push_back((Edge) {idxps[w], length((Segment) {origin, points[w]})});
+        }
+    }
+}
+
+} // namespace bfreeman
\ No newline at end of file